@@ -0,0 +1,153 @@
+// Compares evaluating one expression over columns with the batch evaluator
+// against walking the tree once per row.
+#include "../error_handler/error_handler.hpp"
+#include "../evaluator/batch_evaluator.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace lox;
+
+namespace {
+    /// @brief reference evaluator that walks the tree once per row
+    class RowEvaluator : public ExprVisitor {
+      public:
+        struct Value {
+            bool isNumber;
+            double number;
+            bool boolean;
+        };
+        RowEvaluator(const BatchEvaluator::ColumnSet& columns)
+            : columns_(columns)
+            , row_(0) {}
+        Value evaluate(Expr* expr, size_t row) {
+            row_ = row;
+            expr->accept(this);
+            return result_;
+        }
+        void visitBinaryExpr(BinaryExpr* expr) override {
+            const Value left  = evaluate(expr->left, row_);
+            const Value right = evaluate(expr->right, row_);
+            switch (expr->Operator.type) {
+                case TokenType::PLUS:
+                    result_ = {true, left.number + right.number, false};
+                    break;
+                case TokenType::MINUS:
+                    result_ = {true, left.number - right.number, false};
+                    break;
+                case TokenType::STAR:
+                    result_ = {true, left.number * right.number, false};
+                    break;
+                case TokenType::SLASH:
+                    result_ = {true, left.number / right.number, false};
+                    break;
+                case TokenType::GREATER:
+                    result_ = {false, 0, left.number > right.number};
+                    break;
+                case TokenType::LESS:
+                    result_ = {false, 0, left.number < right.number};
+                    break;
+                case TokenType::EQUAL_EQUAL:
+                    result_ = {false, 0,
+                               left.isNumber ? left.number == right.number
+                                             : left.boolean == right.boolean};
+                    break;
+                default:
+                    result_ = {false, 0, false};
+            }
+        }
+        void visitGroupingExpr(GroupingExpr* expr) override {
+            expr->expression->accept(this);
+        }
+        void visitLiteralExpr(LiteralExpr* expr) override {
+            result_ = {true, expr->value.numberValue, false};
+        }
+        void visitUnaryExpr(UnaryExpr* expr) override {
+            const Value right = evaluate(expr->right, row_);
+            result_ = {true, -right.number, false};
+        }
+        void visitVariableExpr(VariableExpr* expr) override {
+            const Column& column = columns_.at(expr->name.lexeme);
+            if (column.type == Column::Type::NUMBER) {
+                result_ = {true, column.numberValues[row_], false};
+            } else {
+                result_ = {false, 0, column.boolValues[row_] != 0};
+            }
+        }
+
+      private:
+        const BatchEvaluator::ColumnSet& columns_;
+        size_t row_;
+        Value result_;
+    };
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double>(elapsed).count();
+    }
+} // namespace
+
+int main() {
+    const size_t rowCount    = 4000000;
+    const std::string source = "(x + y) * 2 - -y / 3 > x * x == flag";
+
+    ErrorHandler errorHandler;
+    Scanner scanner(source, errorHandler);
+    Parser parser(scanner.scanAndGetTokens(), errorHandler);
+    Expr* expr = parser.parse();
+    if (errorHandler.foundError)
+        return 1;
+
+    std::vector<double> x(rowCount), y(rowCount);
+    std::vector<uint8_t> flag(rowCount);
+    for (size_t i = 0; i < rowCount; ++i) {
+        x[i]    = static_cast<double>(i % 1000) / 10.0;
+        y[i]    = static_cast<double>(i % 777);
+        flag[i] = i % 3 == 0;
+    }
+    BatchEvaluator::ColumnSet columns;
+    columns["x"]    = Column::numbers(x);
+    columns["y"]    = Column::numbers(y);
+    columns["flag"] = Column::bools(flag);
+
+    auto start = std::chrono::steady_clock::now();
+    BatchEvaluator batchEvaluator(columns);
+    const Column batchResult = batchEvaluator.evaluate(expr, rowCount);
+    const double batchSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    BatchEvaluator iterativeEvaluator(columns,
+                                      BatchEvaluator::Mode::ITERATIVE);
+    const Column iterativeResult = iterativeEvaluator.evaluate(expr, rowCount);
+    const double iterativeSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    RowEvaluator rowEvaluator(columns);
+    size_t mismatches = 0;
+    for (size_t row = 0; row < rowCount; ++row) {
+        const bool value = rowEvaluator.evaluate(expr, row).boolean;
+        if (value != (batchResult.boolValues[row] != 0) ||
+            value != (iterativeResult.boolValues[row] != 0))
+            ++mismatches;
+    }
+    const double rowSeconds = secondsSince(start);
+
+    std::cout << "expression: " << source << std::endl;
+    std::cout << "rows:       " << rowCount << std::endl;
+    std::cout << "batch:      " << rowCount / batchSeconds << " rows/s"
+              << std::endl;
+    std::cout << "iterative:  " << rowCount / iterativeSeconds << " rows/s"
+              << std::endl;
+    std::cout << "row by row: " << rowCount / rowSeconds << " rows/s"
+              << std::endl;
+    std::cout << "speedup:    " << rowSeconds / batchSeconds << "x"
+              << std::endl;
+    if (mismatches != 0) {
+        std::cout << "MISMATCH in " << mismatches << " rows" << std::endl;
+        return 1;
+    }
+    return 0;
+}
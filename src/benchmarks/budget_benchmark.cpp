@@ -0,0 +1,168 @@
+// Measures what checking a Budget costs when no limit is hit, by scanning
+// and parsing the same inputs with and without one, then shows how quickly
+// each limit stops a job.
+#include "../error_handler/error_handler.hpp"
+#include "../governor/budget.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace lox;
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    /// @brief scans and parses source, returns the seconds taken. errors is
+    /// set to whatever was reported.
+    double scanAndParse(const std::string& source, Parser::Mode mode,
+                        const Budget* budget, std::string& errors) {
+        ErrorHandler errorHandler;
+        errorHandler.setSource(source);
+        // the parser reports its errors right away, keep them off the
+        // benchmark output
+        std::ostringstream captured;
+        auto previous = std::cout.rdbuf(captured.rdbuf());
+        const auto start = std::chrono::steady_clock::now();
+        Scanner scanner(source, errorHandler, budget);
+        const auto tokens = scanner.scanAndGetTokens();
+        Expr* expr        = nullptr;
+        if (!errorHandler.foundError) {
+            Parser parser(tokens, errorHandler, mode, budget);
+            expr = parser.parse();
+        }
+        const double seconds = secondsSince(start);
+        if (errorHandler.foundError)
+            errorHandler.report();
+        std::cout.rdbuf(previous);
+        errors = captured.str();
+        ASTDeleter deleter;
+        deleter.destroy(expr);
+        return seconds;
+    }
+
+    double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    /// @brief runs the same input without and with a budget that is never
+    /// exceeded many times and reports the medians. The two runs of a trial
+    /// go back to back, alternating which goes first so both see the same
+    /// heap, and the overhead is the median of the per-trial ratios.
+    void measureOverhead(const std::string& name, const std::string& source,
+                         Parser::Mode mode) {
+        std::atomic<bool> cancel(false);
+        Budget budget = Budget::withTimeout(std::chrono::hours(1));
+        budget.maxTokens = 1 << 30;
+        budget.maxNodes  = 1 << 30;
+        budget.maxDepth  = 1 << 30;
+        budget.cancel    = &cancel;
+
+        const int trials = 101;
+        std::vector<double> unbudgeted, budgeted, ratios;
+        std::string errors;
+        for (int trial = 0; trial < trials; ++trial) {
+            double seconds[2];
+            for (int order = 0; order < 2; ++order) {
+                const bool withBudget = (trial + order) % 2 == 1;
+                seconds[withBudget]   = scanAndParse(
+                    source, mode, withBudget ? &budget : nullptr, errors);
+            }
+            unbudgeted.push_back(seconds[0]);
+            budgeted.push_back(seconds[1]);
+            ratios.push_back(seconds[1] / seconds[0]);
+        }
+        std::cout << name << ": median of " << trials << " trials "
+                  << median(unbudgeted) * 1e3 << " ms without, "
+                  << median(budgeted) * 1e3 << " ms with budget, overhead "
+                  << (median(ratios) - 1) * 100 << "%"
+                  << (errors.empty() ? "" : " UNEXPECTED ERROR") << std::endl;
+    }
+
+    void measureLimit(const std::string& name, const std::string& source,
+                      const Budget& budget) {
+        std::string errors;
+        const double seconds =
+            scanAndParse(source, Parser::Mode::ITERATIVE, &budget, errors);
+        // the message without the source line and caret
+        const std::string message = errors.substr(0, errors.find('\n'));
+        std::cout << "  " << name << ": stopped after " << seconds * 1e3
+                  << " ms, " << message << std::endl;
+    }
+} // namespace
+
+int main() {
+#ifdef __linux__
+    // every trial runs on the same core
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(sched_getcpu(), &cpus);
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+#endif
+    std::string flat = "0";
+    for (size_t i = 1; i < 100000; ++i) {
+        const char* operators[] = {" + ", " * ", " - ", " / ", " == "};
+        flat += operators[i % 5];
+        flat += (i % 3 == 0) ? "-x" + std::to_string(i % 10)
+                             : std::to_string(i % 1000);
+    }
+    std::string nested;
+    for (size_t i = 0; i < 10000; ++i)
+        nested += "(-";
+    nested += "1";
+    for (size_t i = 0; i < 10000; ++i)
+        nested += ")";
+
+    measureOverhead("flat, recursive", flat, Parser::Mode::RECURSIVE);
+    measureOverhead("flat, iterative", flat, Parser::Mode::ITERATIVE);
+    measureOverhead("nested, iterative", nested, Parser::Mode::ITERATIVE);
+
+    std::cout << "stopping early:" << std::endl;
+    Budget tokens;
+    tokens.maxTokens = 10000;
+    measureLimit("10000 tokens", flat, tokens);
+    Budget nodes;
+    nodes.maxNodes = 10000;
+    measureLimit("10000 nodes", flat, nodes);
+    Budget depth;
+    depth.maxDepth = 1000;
+    measureLimit("depth 1000", nested, depth);
+    measureLimit("5 ms deadline", flat,
+                 Budget::withTimeout(std::chrono::milliseconds(5)));
+    // a single lexeme as long as the whole input
+    const std::string longString = "\"" + std::string(16 << 20, 'x') + "\"";
+    std::string errors;
+    const double unlimited =
+        scanAndParse(longString, Parser::Mode::ITERATIVE, nullptr, errors);
+    std::cout << "  16 MiB string without a budget: " << unlimited * 1e3
+              << " ms" << std::endl;
+    measureLimit("5 ms deadline, one string", longString,
+                 Budget::withTimeout(std::chrono::milliseconds(5)));
+    measureLimit("5 ms deadline, one comment", "//" + longString,
+                 Budget::withTimeout(std::chrono::milliseconds(5)));
+
+    std::atomic<bool> cancel(false);
+    Budget cancellable;
+    cancellable.cancel = &cancel;
+    std::thread canceller([&cancel]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        cancel = true;
+    });
+    measureLimit("cancel after 5 ms", flat, cancellable);
+    canceller.join();
+    return 0;
+}
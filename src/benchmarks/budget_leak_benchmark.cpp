@@ -0,0 +1,119 @@
+// Checks that a job stopped by a Budget limit or a parse error frees every
+// node it built, in both parser modes and through lox::compile, by counting
+// the blocks allocated through operator new. Kept apart from
+// budget_benchmark since the counting slows down every allocation.
+#include "../error_handler/error_handler.hpp"
+#include "../governor/budget.hpp"
+#include "../lox.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+using namespace lox;
+
+namespace {
+    /// @brief blocks allocated through operator new and not deleted yet
+    std::atomic<long> liveAllocations(0);
+} // namespace
+
+void* operator new(size_t size) {
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    liveAllocations.fetch_add(1, std::memory_order_relaxed);
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory == nullptr)
+        return;
+    liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    operator delete(memory);
+}
+
+namespace {
+    /// @brief scans and parses source, returns the number of blocks that
+    /// are still allocated once everything involved is gone
+    long leakedBy(const std::string& source, Parser::Mode mode,
+                  const Budget* budget) {
+        const long before = liveAllocations.load();
+        {
+            std::ostream discard(nullptr);
+            ErrorHandler errorHandler(discard);
+            errorHandler.setSource(source);
+            Scanner scanner(source, errorHandler, budget);
+            const auto tokens = scanner.scanAndGetTokens();
+            Parser parser(tokens, errorHandler, mode, budget);
+            ASTDeleter deleter;
+            deleter.destroy(parser.parse());
+        }
+        return liveAllocations.load() - before;
+    }
+
+    long leakedByCompile(const std::string& source, const Budget* budget) {
+        const long before = liveAllocations.load();
+        try {
+            compile(source, budget);
+        } catch (const CompileError&) {
+        }
+        return liveAllocations.load() - before;
+    }
+} // namespace
+
+int main() {
+    std::string flat = "0";
+    for (size_t i = 1; i < 10000; ++i) {
+        const char* operators[] = {" + ", " * ", " - ", " / ", " == "};
+        flat += operators[i % 5];
+        flat += (i % 3 == 0) ? "-x" + std::to_string(i % 10)
+                             : std::to_string(i % 1000);
+    }
+    const std::string nested =
+        std::string(2000, '(') + "-1" + std::string(2000, ')');
+    Budget nodes;
+    nodes.maxNodes = 5000;
+    Budget depth;
+    depth.maxDepth = 1000;
+    Budget expired = Budget::withTimeout(std::chrono::seconds(0));
+
+    struct Case {
+        const char* name;
+        std::string source;
+        const Budget* budget;
+    };
+    const Case cases[] = {
+        {"node limit", flat, &nodes},
+        {"depth limit", nested, &depth},
+        {"deadline", flat, &expired},
+        {"unclosed group", flat + " + (1", nullptr},
+        {"missing operand", flat + " * -", nullptr},
+        {"missing operand in a group", nested + " == (1 +)", nullptr},
+    };
+    long total = 0;
+    for (const Case& job : cases) {
+        const long recursive = leakedBy(job.source, Parser::Mode::RECURSIVE,
+                                        job.budget);
+        const long iterative = leakedBy(job.source, Parser::Mode::ITERATIVE,
+                                        job.budget);
+        const long compiled  = leakedByCompile(job.source, job.budget);
+        std::cout << job.name << ": " << recursive << " recursive, "
+                  << iterative << " iterative, " << compiled
+                  << " compiled blocks left" << std::endl;
+        total += recursive + iterative + compiled;
+    }
+    if (total != 0) {
+        std::cout << "LEAKED " << total << " blocks" << std::endl;
+        return 1;
+    }
+    return 0;
+}
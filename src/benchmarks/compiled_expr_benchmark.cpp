@@ -0,0 +1,153 @@
+// Compares compiling an expression once and printing or evaluating the
+// handle many times, also from several threads sharing it, against
+// scanning and parsing it again for every request like lox::run does.
+#include "../error_handler/error_handler.hpp"
+#include "../evaluator/batch_evaluator.hpp"
+#include "../lox.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include "../tools/ast_printer.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lox;
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    /// @brief what lox::run does for a request, minus writing to stdout
+    Expr* scanAndParse(const std::string& source) {
+        ErrorHandler errorHandler;
+        errorHandler.setSource(source);
+        Scanner scanner(source, errorHandler);
+        Parser parser(scanner.scanAndGetTokens(), errorHandler,
+                      Parser::Mode::ITERATIVE);
+        return parser.parse();
+    }
+
+    std::string reparseAndPrint(const std::string& source) {
+        Expr* expr = scanAndParse(source);
+        std::ostringstream out;
+        ASTPrinter printer(ASTPrinter::Mode::ITERATIVE, out);
+        printer.print(expr);
+        ASTDeleter deleter;
+        deleter.destroy(expr);
+        return out.str();
+    }
+
+    Column reparseAndEvaluate(const std::string& source,
+                              const ColumnSet& columns, size_t rows) {
+        Expr* expr = scanAndParse(source);
+        BatchEvaluator evaluator(columns);
+        Column result = evaluator.evaluate(expr, rows);
+        ASTDeleter deleter;
+        deleter.destroy(expr);
+        return result;
+    }
+
+    /// @brief runs request count times on each of threads threads and
+    /// returns requests per second. Clears ok if a result was wrong.
+    template <typename Request>
+    double throughput(size_t threads, size_t count, std::atomic<bool>& ok,
+                      Request request) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([&]() {
+                for (size_t n = 0; n < count; ++n)
+                    if (!request())
+                        ok = false;
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        return threads * count / secondsSince(start);
+    }
+
+    void report(const std::string& name, double reparsed, double compiled,
+                const std::atomic<bool>& ok) {
+        std::cout << "  " << name << ": " << reparsed << " reparsed/s, "
+                  << compiled << " compiled/s, speedup "
+                  << compiled / reparsed << (ok ? "" : " RESULTS DIFFER")
+                  << std::endl;
+    }
+} // namespace
+
+int main() {
+    const std::string source = "(price * quantity - discount) / (1 + tax) > "
+                               "limit == !(-price < 0 == flagged)";
+
+    const size_t rows = 64;
+    ColumnSet columns;
+    std::vector<double> values(rows);
+    std::vector<uint8_t> flags(rows);
+    for (size_t row = 0; row < rows; ++row) {
+        values[row] = static_cast<double>(row % 17);
+        flags[row]  = row % 3 == 0;
+    }
+    for (auto name : {"price", "quantity", "discount", "tax", "limit"})
+        columns.emplace(name, Column::numbers(values));
+    columns.emplace("flagged", Column::bools(flags));
+
+    const auto compiled         = compile(source);
+    const std::string expected  = compiled->print();
+    const Column expectedColumn = reparseAndEvaluate(source, columns, rows);
+    auto sameColumn = [&](const Column& column) {
+        return column.boolValues == expectedColumn.boolValues;
+    };
+
+    const size_t count = 20000;
+    for (size_t threads = 1; threads <= 4; threads *= 2) {
+        std::cout << threads << " threads sharing one handle:" << std::endl;
+        std::atomic<bool> ok(true);
+        const double printReparsed = throughput(threads, count, ok, [&]() {
+            return reparseAndPrint(source) == expected;
+        });
+        const double printCompiled = throughput(threads, count, ok, [&]() {
+            return compiled->print() == expected;
+        });
+        report("print", printReparsed, printCompiled, ok);
+
+        const double evaluateReparsed = throughput(threads, count, ok, [&]() {
+            return sameColumn(reparseAndEvaluate(source, columns, rows));
+        });
+        const double evaluateCompiled = throughput(threads, count, ok, [&]() {
+            return sameColumn(compiled->evaluate(columns, rows));
+        });
+        report("evaluate " + std::to_string(rows) + " rows", evaluateReparsed,
+               evaluateCompiled, ok);
+    }
+
+    try {
+        compile("1 + (2");
+        std::cout << "expected a CompileError" << std::endl;
+        return 1;
+    } catch (const CompileError& error) {
+        std::cout << "compile(\"1 + (2\") throws:" << std::endl
+                  << error.what();
+    }
+
+    // whatever compiles has to print and evaluate as well, however deep
+    const size_t depth  = 300000;
+    const auto deep     = compile(std::string(depth, '(') + "price" +
+                              std::string(depth, ')'));
+    const bool printed  = deep->print().size() > depth;
+    const Column column = deep->evaluate(columns, rows);
+    if (!printed || column.numberValues != values) {
+        std::cout << "price nested " << depth << " levels deep fails"
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "price nested " << depth << " levels deep evaluates"
+              << std::endl;
+    return 0;
+}
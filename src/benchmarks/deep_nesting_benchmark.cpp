@@ -0,0 +1,112 @@
+// Stress test for the iterative parser, tree passes and evaluator on inputs
+// nested a million levels deep, plus a recursive/iterative comparison on
+// shallow input to check the default path didn't get slower.
+#include "../error_handler/error_handler.hpp"
+#include "../evaluator/batch_evaluator.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include "../tools/ast_printer.hpp"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace lox;
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    std::string repeat(const std::string& text, size_t count) {
+        std::string result;
+        result.reserve(text.size() * count);
+        for (size_t i = 0; i < count; ++i)
+            result += text;
+        return result;
+    }
+
+    void runDeep(const std::string& name, const std::string& source) {
+        ErrorHandler errorHandler;
+        errorHandler.setSource(source);
+
+        auto start = std::chrono::steady_clock::now();
+        Scanner scanner(source, errorHandler);
+        const auto tokens        = scanner.scanAndGetTokens();
+        const double scanSeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        Parser parser(tokens, errorHandler, Parser::Mode::ITERATIVE);
+        Expr* expr                = parser.parse();
+        const double parseSeconds = secondsSince(start);
+        if (errorHandler.foundError) {
+            std::cout << name << ": parse failed" << std::endl;
+            return;
+        }
+
+        std::ostringstream sink;
+        start = std::chrono::steady_clock::now();
+        ASTPrinter printer(ASTPrinter::Mode::ITERATIVE, sink);
+        printer.print(expr);
+        const double printSeconds = secondsSince(start);
+
+        BatchEvaluator::ColumnSet columns;
+        columns["x"] = Column::numbers({1, 2, 3, 4});
+        start        = std::chrono::steady_clock::now();
+        BatchEvaluator evaluator(columns, BatchEvaluator::Mode::ITERATIVE);
+        const Column values          = evaluator.evaluate(expr, 4);
+        const double evaluateSeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        ASTDeleter deleter;
+        deleter.destroy(expr);
+        const double deleteSeconds = secondsSince(start);
+
+        std::cout << name << ": scan " << scanSeconds * 1e3 << " ms, parse "
+                  << parseSeconds * 1e3 << " ms, print "
+                  << printSeconds * 1e3 << " ms (" << sink.str().size()
+                  << " bytes), evaluate " << evaluateSeconds * 1e3
+                  << " ms (first row " << values.numberValues[0]
+                  << "), delete " << deleteSeconds * 1e3 << " ms"
+                  << std::endl;
+    }
+
+    double parseShallow(const std::vector<Token>& tokens, Parser::Mode mode,
+                        size_t iterations) {
+        ErrorHandler errorHandler;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            Parser parser(tokens, errorHandler, mode);
+            ASTDeleter deleter;
+            deleter.destroy(parser.parse());
+        }
+        return iterations / secondsSince(start);
+    }
+} // namespace
+
+int main() {
+    const size_t depth = 1000000;
+    std::cout << "depth " << depth << std::endl;
+    runDeep("parentheses", repeat("(", depth) + "x" + repeat(")", depth));
+    runDeep("unary", repeat("-", depth) + "x");
+    runDeep("right nested",
+            repeat("1 + (", depth) + "x" + repeat(")", depth));
+
+    const std::string shallow = "(a + 2) * -b / 4 - (c - 1) > 2 == !false";
+    ErrorHandler errorHandler;
+    Scanner scanner(shallow, errorHandler);
+    const auto tokens       = scanner.scanAndGetTokens();
+    const size_t iterations = 200000;
+    const double recursive =
+        parseShallow(tokens, Parser::Mode::RECURSIVE, iterations);
+    const double iterative =
+        parseShallow(tokens, Parser::Mode::ITERATIVE, iterations);
+    std::cout << "shallow recursive: " << recursive << " parses/s"
+              << std::endl;
+    std::cout << "shallow iterative: " << iterative << " parses/s"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Checks expressions parsed at compile time against the runtime Scanner and
+// Parser on the same sources, and measures the startup work they save.
+#include "../error_handler/error_handler.hpp"
+#include "../parser/embedded_expr.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include "../tools/ast_printer.hpp"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace lox;
+
+namespace {
+    constexpr auto arithmetic = embed("(a + 12.5) * -b / 4 - (c - 1)");
+    constexpr auto comparison = embed("1 <= 2 < x == !false != nil");
+    constexpr auto strings    = embed("\"lox\" == \"\" // comment");
+    constexpr auto nested     = embed("((((-(-(1)))))) * (2 + (3 * (4 - 5)))");
+
+    // the table is really built by the compiler
+    static_assert(embed("1 + 2 * 3").nodeCount == 5, "");
+    static_assert(arithmetic.nodes[arithmetic.root].kind ==
+                      EmbeddedNode::Kind::BINARY,
+                  "");
+    // numbers are decoded into the table, correctly rounded
+    static_assert(embed("12.5").nodes[0].number == 12.5, "");
+    static_assert(embed("0.1").nodes[0].number == 0.1, "");
+    static_assert(embed("9007199254740992").nodes[0].number ==
+                      9007199254740992.0,
+                  "");
+    static_assert(embed("1000000000000000000000").nodes[0].number == 1e21,
+                  "");
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    Expr* parseAtRuntime(const std::string& source) {
+        ErrorHandler errorHandler;
+        Scanner scanner(source, errorHandler);
+        Parser parser(scanner.scanAndGetTokens(), errorHandler);
+        return parser.parse();
+    }
+
+    std::string print(Expr* expr) {
+        std::ostringstream out;
+        ASTPrinter printer(ASTPrinter::Mode::RECURSIVE, out);
+        printer.print(expr);
+        return out.str();
+    }
+
+    /// @brief returns false if the runtime parser disagrees with the table
+    template <size_t N>
+    bool check(const EmbeddedExpr<N>& embedded) {
+        const std::string source = embedded.source;
+        ASTDeleter deleter;
+
+        Expr* runtimeExpr          = parseAtRuntime(source);
+        const std::string expected = print(runtimeExpr);
+        deleter.destroy(runtimeExpr);
+
+        std::ostringstream direct;
+        embedded.print(direct);
+        Expr* converted           = embedded.toExpr();
+        const std::string rebuilt = print(converted);
+        deleter.destroy(converted);
+
+        const bool same = direct.str() == expected && rebuilt == expected;
+        std::cout << (same ? "same:     " : "MISMATCH: ") << source << " -> "
+                  << expected << std::endl;
+        return same;
+    }
+
+    template <size_t N>
+    double runtimeParsesPerSecond(const EmbeddedExpr<N>& embedded) {
+        const std::string source = embedded.source;
+        const size_t iterations  = 100000;
+        ASTDeleter deleter;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            deleter.destroy(parseAtRuntime(source));
+        return iterations / secondsSince(start);
+    }
+
+    /// @brief builds the runtime tree from the table, the work left at
+    /// startup for an embedded expression
+    template <size_t N>
+    double conversionsPerSecond(const EmbeddedExpr<N>& embedded) {
+        const size_t iterations = 100000;
+        ASTDeleter deleter;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            deleter.destroy(embedded.toExpr());
+        return iterations / secondsSince(start);
+    }
+} // namespace
+
+int main() {
+    bool same = check(arithmetic);
+    same      = check(comparison) && same;
+    same      = check(strings) && same;
+    same      = check(nested) && same;
+
+    const double parsed    = runtimeParsesPerSecond(arithmetic);
+    const double converted = conversionsPerSecond(arithmetic);
+    std::cout << "runtime scan + parse: " << 1e9 / parsed
+              << " ns per expression, embedded toExpr: " << 1e9 / converted
+              << " ns" << std::endl;
+    return same ? 0 : 1;
+}
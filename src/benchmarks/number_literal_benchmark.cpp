@@ -0,0 +1,191 @@
+// Scans, parses and prints a number-heavy input, and compares the number
+// decoding and formatting Literal uses (from_chars, shortest round-trip
+// to_chars) with the usual library alternatives on the same values.
+#include "../error_handler/error_handler.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/literal.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include "../tools/ast_printer.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace lox;
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    uint64_t nextRandom(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    /// @brief integers, short decimals and long decimals with up to 17
+    /// significant digits, like measurements and prices would have
+    std::vector<std::string> generateNumbers(size_t count) {
+        std::vector<std::string> numbers;
+        uint64_t state = 88172645463325252ull;
+        for (size_t i = 0; i < count; ++i) {
+            std::string number = std::to_string(nextRandom(state) % 100000);
+            switch (i % 3) {
+                case 1:
+                    number += "." + std::to_string(nextRandom(state) % 100);
+                    break;
+                case 2:
+                    number += "." + std::to_string(nextRandom(state) %
+                                                   1000000000000ull);
+                    break;
+            }
+            numbers.push_back(number);
+        }
+        return numbers;
+    }
+
+    /// @brief runs work once and prints how many items per second it did
+    template <typename Work>
+    void measure(const std::string& name, size_t items, Work work) {
+        const auto start     = std::chrono::steady_clock::now();
+        const size_t checked = work();
+        const double seconds = secondsSince(start);
+        std::cout << "  " << std::left << std::setw(28) << name << std::right
+                  << std::setw(8) << items / seconds / 1e6 << " M/s"
+                  << " (checksum " << checked << ")" << std::endl;
+    }
+} // namespace
+
+int main() {
+    const size_t count                    = 1000000;
+    const std::vector<std::string> digits = generateNumbers(count);
+    std::string source                    = digits[0];
+    for (size_t i = 1; i < count; ++i)
+        source += (i % 2 ? " + " : " * ") + digits[i];
+
+    std::cout << "front end on " << count << " numbers ("
+              << source.size() / 1e6 << " MB):" << std::endl;
+    ErrorHandler errorHandler;
+    auto start = std::chrono::steady_clock::now();
+    Scanner scanner(source, errorHandler);
+    const auto tokens = scanner.scanAndGetTokens();
+    std::cout << "  scan:  " << secondsSince(start) * 1e3 << " ms"
+              << std::endl;
+    start = std::chrono::steady_clock::now();
+    Parser parser(tokens, errorHandler, Parser::Mode::ITERATIVE);
+    Expr* expr = parser.parse();
+    std::cout << "  parse: " << secondsSince(start) * 1e3 << " ms"
+              << std::endl;
+    start = std::chrono::steady_clock::now();
+    std::ostringstream printed;
+    ASTPrinter printer(ASTPrinter::Mode::ITERATIVE, printed);
+    printer.print(expr);
+    std::cout << "  print: " << secondsSince(start) * 1e3 << " ms ("
+              << printed.str().size() / 1e6 << " MB)" << std::endl;
+    ASTDeleter deleter;
+    deleter.destroy(expr);
+
+    std::vector<double> values;
+    for (const auto& token : tokens)
+        if (token.type == TokenType::NUMBER)
+            values.push_back(token.literal.numberValue);
+
+    std::cout << "decoding, numbers per second:" << std::endl;
+    measure("Literal::parseNumber", count, [&]() {
+        size_t same = 0;
+        for (size_t i = 0; i < count; ++i)
+            same += Literal::parseNumber(digits[i]).numberValue == values[i];
+        return same;
+    });
+    measure("strtod", count, [&]() {
+        size_t same = 0;
+        for (size_t i = 0; i < count; ++i)
+            same += std::strtod(digits[i].c_str(), nullptr) == values[i];
+        return same;
+    });
+    measure("std::stod", count, [&]() {
+        size_t same = 0;
+        for (size_t i = 0; i < count; ++i)
+            same += std::stod(digits[i]) == values[i];
+        return same;
+    });
+
+    std::cout << "formatting, numbers per second:" << std::endl;
+    char buffer[Literal::maxNumberLength];
+    measure("Literal::formatNumber", count, [&]() {
+        size_t length = 0;
+        for (double value : values)
+            length += Literal::formatNumber(value, buffer);
+        return length;
+    });
+    measure("snprintf %.17g", count, [&]() {
+        size_t length = 0;
+        for (double value : values)
+            length += std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        return length;
+    });
+    measure("ostream precision 17", count, [&]() {
+        std::ostringstream out;
+        out << std::setprecision(17);
+        for (double value : values)
+            out << value;
+        return out.str().size();
+    });
+
+    // numbers whose exact value has far more digits than it takes to read
+    // them back must print those few digits
+    const std::pair<const char*, const char*> longNumbers[] = {
+        {"100000000000000000000000", "1e+23"},
+        {"123456789012345678901234567890", "1.2345678901234568e+29"},
+        {"12345678901234567890123456789012345", "1.234567890123457e+34"},
+        {"100000000000000000000", "100000000000000000000"},
+        {"0.000001", "0.000001"},
+        {"0.0000001", "1e-7"},
+        {"0.0000000125", "1.25e-8"},
+        {"0.1", "0.1"}};
+    size_t mismatches = 0;
+    for (const auto& [digits, expected] : longNumbers) {
+        const double value  = Literal::parseNumber(digits).numberValue;
+        const size_t length = Literal::formatNumber(value, buffer);
+        if (std::string(buffer, length) != expected) {
+            std::cout << digits << " printed as "
+                      << std::string(buffer, length) << ", expected "
+                      << expected << std::endl;
+            ++mismatches;
+        }
+        values.push_back(value);
+    }
+
+    // the shortest form must still read back as the exact same double, for
+    // the scanned values and for random bit patterns
+    uint64_t state        = 2463534242ull;
+    const size_t patterns = 1000000;
+    for (size_t i = 0; i < values.size() + patterns; ++i) {
+        double value = 0;
+        if (i < values.size()) {
+            value = values[i];
+        } else {
+            const uint64_t bits = nextRandom(state);
+            std::memcpy(&value, &bits, sizeof(value));
+            if (!std::isfinite(value))
+                continue;
+        }
+        const size_t length = Literal::formatNumber(value, buffer);
+        const std::string text(buffer, length);
+        mismatches += std::strtod(text.c_str(), nullptr) != value;
+    }
+    std::cout << "mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Prints a generated million-node tree with the parallel printer at several
+// thread counts and compares time and output against the sequential
+// ASTPrinter. Speedups only mean something with as many cores as threads,
+// so the number of hardware threads is printed first.
+#include "../error_handler/error_handler.hpp"
+#include "../parallel/parallel_printer.hpp"
+#include "../parallel/work_stealing_pool.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include "../tools/ast_printer.hpp"
+#include "../tools/subtree_sizes.hpp"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace lox;
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    /// @brief balanced tree of binary expressions with 2^depth leaves
+    void generateBalanced(std::string& source, size_t depth, size_t& leaf) {
+        if (depth == 0) {
+            source += std::to_string(leaf++ % 1000);
+            return;
+        }
+        const char* operators[] = {" + ", " * ", " - ", " / "};
+        source += "(";
+        generateBalanced(source, depth - 1, leaf);
+        source += operators[depth % 4];
+        generateBalanced(source, depth - 1, leaf);
+        source += ")";
+    }
+
+    void measure(const std::string& name, const std::string& source) {
+        ErrorHandler errorHandler;
+        Scanner scanner(source, errorHandler);
+        Parser parser(scanner.scanAndGetTokens(), errorHandler,
+                      Parser::Mode::ITERATIVE);
+        Expr* expr = parser.parse();
+
+        auto start = std::chrono::steady_clock::now();
+        SubtreeSizes sizes;
+        sizes.compute(expr);
+        std::cout << name << ": " << sizes.of(0) << " nodes, sizes in "
+                  << secondsSince(start) * 1e3 << " ms" << std::endl;
+
+        start = std::chrono::steady_clock::now();
+        std::ostringstream out;
+        ASTPrinter printer(ASTPrinter::Mode::ITERATIVE, out);
+        printer.print(expr);
+        const std::string expected     = out.str();
+        const double sequentialSeconds = secondsSince(start);
+        std::cout << "  sequential: " << sequentialSeconds * 1e3 << " ms"
+                  << std::endl;
+
+        for (size_t threads = 1; threads <= 8; threads *= 2) {
+            WorkStealingPool pool(threads);
+            ParallelPrinter parallelPrinter(pool, sizes);
+            start                     = std::chrono::steady_clock::now();
+            const std::string printed = parallelPrinter.print(expr);
+            const double seconds      = secondsSince(start);
+            std::cout << "  " << threads << " threads: " << seconds * 1e3
+                      << " ms, speedup " << sequentialSeconds / seconds
+                      << (printed == expected ? "" : " OUTPUT DIFFERS")
+                      << std::endl;
+        }
+        ASTDeleter deleter;
+        deleter.destroy(expr);
+    }
+} // namespace
+
+int main() {
+    std::cout << std::thread::hardware_concurrency() << " hardware threads"
+              << std::endl;
+    std::string balanced;
+    size_t leaf = 0;
+    generateBalanced(balanced, 19, leaf);
+    measure("balanced", balanced);
+
+    std::string chain = "0";
+    for (size_t i = 1; i < 1000000; ++i)
+        chain += " + " + std::to_string(i % 1000);
+    measure("left-deep chain", chain);
+
+    // a task that throws still finishes, its waiter gets the exception
+    WorkStealingPool pool(2);
+    const auto failing =
+        pool.submit([]() { throw std::runtime_error("task failed"); });
+    try {
+        pool.wait(failing);
+        std::cout << "a task's exception was lost" << std::endl;
+        return 1;
+    } catch (const std::runtime_error&) {
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Compares the pipelined scan -> parse -> print path against running the
+// stages one after another, measuring time to the first printed expression
+// (latency) and total time (throughput).
+#include "../error_handler/error_handler.hpp"
+#include "../pipeline/pipeline.hpp"
+#include <chrono>
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+using namespace lox;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief discards output but remembers when the first byte arrived
+    class TimingBuffer : public std::streambuf {
+      public:
+        TimingBuffer()
+            : bytes(0)
+            , sawOutput(false) {}
+        size_t bytes;
+        bool sawOutput;
+        Clock::time_point firstOutput;
+
+      protected:
+        int overflow(int c) override {
+            record(1);
+            return c;
+        }
+        std::streamsize xsputn(const char*, std::streamsize count) override {
+            record(count);
+            return count;
+        }
+
+      private:
+        void record(std::streamsize count) {
+            if (!sawOutput) {
+                sawOutput   = true;
+                firstOutput = Clock::now();
+            }
+            bytes += count;
+        }
+    };
+
+    double millisecondsBetween(Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void measure(const std::string& name, const std::string& source,
+                 bool pipelined) {
+        ErrorHandler errorHandler;
+        TimingBuffer buffer;
+        std::ostream out(&buffer);
+        Pipeline pipeline(source, errorHandler, out);
+        const auto start = Clock::now();
+        if (pipelined) {
+            pipeline.run();
+        } else {
+            pipeline.runSequential();
+        }
+        const auto end       = Clock::now();
+        const double total   = millisecondsBetween(start, end);
+        const double seconds = total / 1e3;
+        std::cout << name << ": first output after "
+                  << millisecondsBetween(start, buffer.firstOutput)
+                  << " ms, total " << total << " ms, "
+                  << source.size() / seconds / 1e6 << " MB/s in, "
+                  << buffer.bytes / seconds / 1e6 << " MB/s out" << std::endl;
+    }
+} // namespace
+
+int main() {
+    const size_t statements = 200000;
+    std::string source;
+    for (size_t i = 0; i < statements; ++i)
+        source += "(a + 12.5) * -b / 4 - (c - 1) > 2 == !false;\n";
+    std::cout << statements << " statements, " << source.size() << " bytes"
+              << std::endl;
+    measure("sequential", source, false);
+    measure("pipelined ", source, true);
+
+    ErrorHandler errorHandler;
+    try {
+        Pipeline pipeline(source, errorHandler, std::cout, 0);
+        std::cout << "a batch size of 0 was accepted" << std::endl;
+        return 1;
+    } catch (const std::invalid_argument&) {
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Replays a request stream where the same expressions come back with
+// different whitespace, comments and redundant parentheses, with and without
+// the result cache.
+#include "../cache/result_cache.hpp"
+#include "../error_handler/error_handler.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace lox;
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    /// @brief every request is a random variant of one of distinct
+    /// expressions, drawn with a fixed seed
+    std::vector<std::string> makeRequests(size_t count, size_t distinct) {
+        std::vector<std::string> requests;
+        uint64_t state = 88172645463325252ull;
+        for (size_t i = 0; i < count; ++i) {
+            // xorshift64
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            const std::string id = std::to_string(state % distinct);
+            const std::string base =
+                "(x" + id + " + " + id + ") * -y / 4 - z" + id + " > 2";
+            switch ((state >> 32) % 4) {
+                case 0:
+                    requests.push_back(base);
+                    break;
+                case 1:
+                    requests.push_back("  " + base + "   // request " +
+                                       std::to_string(i));
+                    break;
+                case 2:
+                    requests.push_back("((" + base + "))");
+                    break;
+                default:
+                    requests.push_back("(x" + id + "+" + id + ")*-y/4-z" +
+                                       id + ">2");
+            }
+        }
+        return requests;
+    }
+
+    void runCached(const std::string& name,
+                   const std::vector<std::string>& requests, size_t maxBytes) {
+        ResultCache cache(maxBytes);
+        ErrorHandler errorHandler;
+        std::string result;
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& request : requests)
+            cache.get(request, errorHandler, result);
+        const double seconds = secondsSince(start);
+        const auto& stats    = cache.stats();
+        std::cout << name << ": " << requests.size() / seconds
+                  << " requests/s, hits " << stats.hits << " (token "
+                  << stats.tokenHits << ", tree " << stats.treeHits
+                  << "), misses " << stats.misses << ", evictions "
+                  << stats.evictions << ", " << stats.entries
+                  << " entries in " << stats.bytes << " bytes" << std::endl;
+    }
+} // namespace
+
+int main() {
+    const auto requests = makeRequests(200000, 1000);
+
+    ErrorHandler errorHandler;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& request : requests) {
+        Scanner scanner(request, errorHandler);
+        Parser parser(scanner.scanAndGetTokens(), errorHandler,
+                      Parser::Mode::ITERATIVE);
+        Expr* expr = parser.parse();
+        (void)ResultCache::printCanonical(expr);
+        ASTDeleter deleter;
+        deleter.destroy(expr);
+    }
+    std::cout << "uncached:         " << requests.size() / secondsSince(start)
+              << " requests/s" << std::endl;
+
+    runCached("cached (16 MiB)  ", requests, 16 << 20);
+    runCached("cached (128 KiB) ", requests, 128 << 10);
+
+    // a request that fails must not fail or change the ones after it
+    ResultCache cache(1 << 20);
+    std::string result = "unchanged";
+    const bool failed  = !cache.get("1 + (2", errorHandler, result);
+    const bool kept    = result == "unchanged";
+    const bool next    = cache.get("1 + 2", errorHandler, result);
+    std::cout << "after a bad request: " << (failed && kept ? "" : "NOT ")
+              << "rejected, next " << (next ? "" : "NOT ") << "served as "
+              << result << std::endl;
+    return failed && kept && next && result == "(+ 1 2)" ? 0 : 1;
+}
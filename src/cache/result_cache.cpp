@@ -0,0 +1,237 @@
+#include "result_cache.hpp"
+#include "../error_handler/error_handler.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include "../tools/ast_printer.hpp"
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+using namespace lox;
+
+namespace {
+    /// @brief rough per-node cost of the list and the hash indices, used to
+    /// keep the memory estimate honest for small values
+    const size_t nodeOverheadBytes = 32;
+
+    /// @brief builds the bytes of a cache key
+    class KeyWriter {
+      public:
+        void add(const void* data, size_t size) {
+            bytes.append(static_cast<const char*>(data), size);
+        }
+        void add(char tag) {
+            bytes += tag;
+        }
+        void add(const std::string& text) {
+            // the length keeps "ab"+"c" and "a"+"bc" apart
+            const uint32_t size = static_cast<uint32_t>(text.size());
+            add(&size, sizeof(size));
+            add(text.data(), text.size());
+        }
+        std::string bytes;
+    };
+
+    /// @brief 64-bit FNV-1a
+    uint64_t hashKey(const std::string& bytes) {
+        uint64_t value = 14695981039346656037ull;
+        for (const char byte : bytes) {
+            value ^= static_cast<unsigned char>(byte);
+            value *= 1099511628211ull;
+        }
+        return value;
+    }
+
+    /// @brief the lexemes separated by spaces. Scanning that text again
+    /// gives the same tokens, so equal keys mean equal token streams.
+    std::string tokenKey(const std::vector<Token>& tokens) {
+        std::string key;
+        for (const auto& token : tokens) {
+            key += token.lexeme;
+            key += ' ';
+        }
+        return key;
+    }
+
+    /// @brief writes the tree in pre-order, skipping GroupingExpr nodes.
+    /// Every node kind has a fixed number of children so the pre-order
+    /// sequence identifies the tree. Uses a work stack so deep trees are
+    /// fine.
+    class TreeKey : public ExprVisitor {
+      public:
+        std::string key(Expr* expr) {
+            pending_.push_back(expr);
+            while (!pending_.empty()) {
+                Expr* next = pending_.back();
+                pending_.pop_back();
+                next->accept(this);
+            }
+            return std::move(key_.bytes);
+        }
+        void visitBinaryExpr(BinaryExpr* expr) override {
+            key_.add('B');
+            key_.add(static_cast<char>(expr->Operator.type));
+            pending_.push_back(expr->right);
+            pending_.push_back(expr->left);
+        }
+        void visitGroupingExpr(GroupingExpr* expr) override {
+            pending_.push_back(expr->expression);
+        }
+        void visitLiteralExpr(LiteralExpr* expr) override {
+            const Literal& literal = expr->value;
+            key_.add('L');
+            key_.add(static_cast<char>(literal.type));
+            if (literal.type == Literal::Type::BOOL)
+                key_.add(static_cast<char>(literal.boolValue));
+            if (literal.type == Literal::Type::NUMBER)
+                key_.add(&literal.numberValue, sizeof(literal.numberValue));
+            if (literal.type == Literal::Type::STRING)
+                key_.add(literal.stringValue);
+        }
+        void visitUnaryExpr(UnaryExpr* expr) override {
+            key_.add('U');
+            key_.add(static_cast<char>(expr->Operator.type));
+            pending_.push_back(expr->right);
+        }
+        void visitVariableExpr(VariableExpr* expr) override {
+            key_.add('V');
+            key_.add(expr->name.lexeme);
+        }
+
+      private:
+        KeyWriter key_;
+        std::vector<Expr*> pending_;
+    };
+} // namespace
+
+ResultCache::ResultCache(size_t maxBytes, Compute compute)
+    : maxBytes_(maxBytes)
+    , compute_(compute)
+    , stats_({0, 0, 0, 0, 0, 0, 0}) {}
+
+bool ResultCache::get(const std::string& source, ErrorHandler& errorHandler,
+                      std::string& result) {
+    // the parser reports as soon as it fails, keep that off stdout. A
+    // handler per request also keeps earlier errors from failing this one.
+    std::ostream discard(nullptr);
+    ErrorHandler errors(discard);
+    errors.setSource(source);
+    Scanner scanner(source, errors);
+    const auto tokens = scanner.scanAndGetTokens();
+    if (errors.foundError) {
+        errorHandler.append(errors);
+        return false;
+    }
+    // cheap lookup first, only the scanner has run so far
+    Key byTokens;
+    byTokens.bytes     = tokenKey(tokens);
+    byTokens.hash      = hashKey(byTokens.bytes);
+    const auto byToken = byTokenHash_.find(byTokens.hash);
+    if (byToken != byTokenHash_.end()) {
+        const auto& aliases = byToken->second->tokenKeys;
+        if (std::find(aliases.begin(), aliases.end(), byTokens) !=
+            aliases.end()) {
+            ++stats_.tokenHits;
+            ++stats_.hits;
+            result = touch(byToken->second);
+            return true;
+        }
+    }
+
+    Parser parser(tokens, errors, Parser::Mode::ITERATIVE);
+    Expr* expr = parser.parse();
+    ASTDeleter deleter;
+    if (errors.foundError) {
+        deleter.destroy(expr);
+        errorHandler.append(errors);
+        return false;
+    }
+    TreeKey treeKey;
+    Key byTree;
+    byTree.bytes     = treeKey.key(expr);
+    byTree.hash      = hashKey(byTree.bytes);
+    const auto found = byTreeHash_.find(byTree.hash);
+    if (found != byTreeHash_.end() && found->second->tree == byTree) {
+        ++stats_.treeHits;
+        ++stats_.hits;
+        addTokenKey(found->second, std::move(byTokens));
+        result = touch(found->second);
+    } else {
+        // on a hash collision the new entry takes over the index slot
+        ++stats_.misses;
+        entries_.push_front({std::move(byTree), {}, compute_(expr)});
+        byTreeHash_[entries_.front().tree.hash] = entries_.begin();
+        stats_.bytes += entryBytes(entries_.front());
+        addTokenKey(entries_.begin(), std::move(byTokens));
+        result = entries_.front().value;
+    }
+    deleter.destroy(expr);
+    evict();
+    stats_.entries = entries_.size();
+    return true;
+}
+
+const ResultCache::Stats& ResultCache::stats() const {
+    return stats_;
+}
+
+void ResultCache::clear() {
+    entries_.clear();
+    byTreeHash_.clear();
+    byTokenHash_.clear();
+    stats_.entries = 0;
+    stats_.bytes   = 0;
+}
+
+std::string ResultCache::printCanonical(Expr* expr) {
+    std::ostringstream out;
+    ASTPrinter printer(ASTPrinter::Mode::ITERATIVE, out, false);
+    printer.print(expr);
+    return out.str();
+}
+
+const std::string& ResultCache::touch(EntryList::iterator entry) {
+    entries_.splice(entries_.begin(), entries_, entry);
+    return entry->value;
+}
+
+bool ResultCache::Key::operator==(const Key& other) const {
+    return hash == other.hash && bytes == other.bytes;
+}
+
+void ResultCache::addTokenKey(EntryList::iterator entry, Key tokenKey) {
+    stats_.bytes -= entryBytes(*entry);
+    byTokenHash_[tokenKey.hash] = entry;
+    entry->tokenKeys.push_back(std::move(tokenKey));
+    stats_.bytes += entryBytes(*entry);
+}
+
+void ResultCache::evict() {
+    while (stats_.bytes > maxBytes_ && !entries_.empty()) {
+        const auto last = std::prev(entries_.end());
+        // after a hash collision a slot may point to another entry by now
+        for (const auto& tokenKey : last->tokenKeys) {
+            const auto byToken = byTokenHash_.find(tokenKey.hash);
+            if (byToken != byTokenHash_.end() && byToken->second == last)
+                byTokenHash_.erase(byToken);
+        }
+        const auto byTree = byTreeHash_.find(last->tree.hash);
+        if (byTree != byTreeHash_.end() && byTree->second == last)
+            byTreeHash_.erase(byTree);
+        stats_.bytes -= entryBytes(*last);
+        entries_.erase(last);
+        ++stats_.evictions;
+    }
+}
+
+size_t ResultCache::entryBytes(const Entry& entry) {
+    size_t bytes = sizeof(Entry) + entry.tree.bytes.capacity() +
+                   entry.value.capacity() +
+                   entry.tokenKeys.capacity() * sizeof(Key) +
+                   (entry.tokenKeys.size() + 2) * nodeOverheadBytes;
+    for (const auto& tokenKey : entry.tokenKeys)
+        bytes += tokenKey.bytes.capacity();
+    return bytes;
+}
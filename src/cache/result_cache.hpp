@@ -0,0 +1,85 @@
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include "../Expr.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lox {
+    // forward declarations
+    class ErrorHandler;
+
+    /// @brief bounded LRU cache of per-expression results for callers that
+    /// see the same expressions over and over.
+    ///
+    /// A request is first looked up by its token stream, which already
+    /// ignores whitespace and comments. On a miss it is parsed and looked up
+    /// again by its tree with GroupingExpr nodes skipped, so "(1 + 2)" and
+    /// "1+2" share an entry. Because of that the cached value must not
+    /// depend on parentheses: the default is the canonical printed tree
+    /// (see ASTPrinter's printGroups). The indices are keyed by 64-bit
+    /// hashes, every hit is checked against the full key.
+    class ResultCache {
+      public:
+        using Compute = std::function<std::string(Expr*)>;
+        struct Stats {
+            /// @brief hits found by token hash, by tree hash and their sum
+            size_t tokenHits;
+            size_t treeHits;
+            size_t hits;
+            size_t misses;
+            size_t evictions;
+            size_t entries;
+            /// @brief estimated memory held by the cache
+            size_t bytes;
+        };
+        ResultCache(size_t maxBytes, Compute compute = printCanonical);
+        /// @brief looks up or computes the result for source. If source
+        /// doesn't scan or parse, returns false, leaves result alone, caches
+        /// nothing and adds the errors to errorHandler without reporting
+        /// them. Earlier errors in errorHandler don't matter.
+        bool get(const std::string& source, ErrorHandler& errorHandler,
+                 std::string& result);
+        const Stats& stats() const;
+        void clear();
+        /// @brief the default Compute
+        static std::string printCanonical(Expr* expr);
+
+      private:
+        struct Key {
+            uint64_t hash;
+            std::string bytes;
+            bool operator==(const Key& other) const;
+        };
+        struct Entry {
+            Key tree;
+            /// @brief every token stream that resolved to this entry
+            std::vector<Key> tokenKeys;
+            std::string value;
+        };
+        using EntryList = std::list<Entry>;
+
+        /// @brief marks entry as most recently used and returns its value
+        const std::string& touch(EntryList::iterator entry);
+        /// @brief adds a token stream alias for entry
+        void addTokenKey(EntryList::iterator entry, Key tokenKey);
+        /// @brief drops least recently used entries until under maxBytes_
+        void evict();
+        static size_t entryBytes(const Entry& entry);
+
+        const size_t maxBytes_;
+        const Compute compute_;
+        Stats stats_;
+        /// @brief most recently used first
+        EntryList entries_;
+        std::unordered_map<uint64_t, EntryList::iterator> byTreeHash_;
+        std::unordered_map<uint64_t, EntryList::iterator> byTokenHash_;
+    };
+} // namespace lox
+
+#endif // RESULT_CACHE_HPP
@@ -1,26 +1,61 @@
 #include "error_handler.hpp"
-#include <iostream>
+#include "../scanner/source_map.hpp"
+#include <sstream>
 
 using namespace lox;
 
-ErrorHandler::ErrorHandler()
+ErrorHandler::ErrorHandler(std::ostream& out)
     : errorList()
-    , foundError(false) {}
+    , foundError(false)
+    , out_(out)
+    , source_(nullptr) {}
+
+ErrorHandler::~ErrorHandler() = default;
+
+void ErrorHandler::setSource(const std::string& source) {
+    source_ = &source;
+    sourceMap_.reset();
+}
 
 void ErrorHandler::report() const {
-    for (const auto error : errorList) {
-        std::cout << "[line " + std::to_string(error.line) + "] Error " +
-                         error.where + ": " + error.message
-                  << std::endl;
+    out_ << toString() << std::flush;
+}
+
+std::string ErrorHandler::toString() const {
+    std::ostringstream out;
+    for (const auto& error : errorList) {
+        out << "[line " + std::to_string(error.line) + ":" +
+                   std::to_string(error.column) + "] Error " + error.where +
+                   ": " + error.message
+            << std::endl;
+        if (error.line == 0)
+            continue;
+        out << SourceMap::snippet(error.sourceLine, error.column);
     }
+    return out.str();
 }
 
-void ErrorHandler::add(int line, const std::string& where,
+void ErrorHandler::add(size_t offset, const std::string& where,
                        const std::string& message) {
-    errorList.push_back({line, where, message});
+    ErrorInfo error{0, 0, where, message, ""};
+    if (source_ != nullptr) {
+        if (!sourceMap_)
+            sourceMap_.reset(new SourceMap(*source_));
+        const auto location = sourceMap_->locate(offset);
+        error.line          = location.line;
+        error.column        = location.column;
+        error.sourceLine    = sourceMap_->lineText(location.line);
+    }
+    errorList.push_back(error);
     foundError = true;
 }
 
+void ErrorHandler::append(const ErrorHandler& other) {
+    errorList.insert(errorList.end(), other.errorList.begin(),
+                     other.errorList.end());
+    foundError = foundError || other.foundError;
+}
+
 void ErrorHandler::clear() {
     errorList.clear();
 }
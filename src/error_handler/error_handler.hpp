@@ -1,26 +1,51 @@
 #ifndef ERROR_HANDLER_HPP
 #define ERROR_HANDLER_HPP
 
+#include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace lox {
+    // forward declarations
+    class SourceMap;
+
     class ErrorHandler {
       public:
         struct ErrorInfo {
-            int line;
+            /// @brief 1-based line and column, 0 if no source was set
+            size_t line;
+            size_t column;
             std::string where;
             std::string message;
+            /// @brief text of the offending line
+            std::string sourceLine;
         };
-        ErrorHandler();
+        /// @brief report writes to out, which must outlive the handler
+        explicit ErrorHandler(std::ostream& out = std::cout);
+        ~ErrorHandler();
+        /// @brief sets the source that offsets passed to add refer to. The
+        /// source must outlive any following add calls.
+        void setSource(const std::string& source);
         void report() const;
-        void add(int line, const std::string& where,
+        /// @brief the text report writes
+        std::string toString() const;
+        /// @brief adds an error at the given byte offset into the source
+        void add(size_t offset, const std::string& where,
                  const std::string& message);
+        /// @brief adds the errors of other, whose locations are already
+        /// resolved, after the ones in this handler
+        void append(const ErrorHandler& other);
         void clear();
         bool foundError;
 
       private:
         std::vector<ErrorInfo> errorList;
+        std::ostream& out_;
+        const std::string* source_;
+        /// @brief built on the first error so error-free runs never pay for
+        /// the newline index
+        std::unique_ptr<SourceMap> sourceMap_;
     };
 } // namespace lox
 
@@ -0,0 +1,402 @@
+#include "batch_evaluator.hpp"
+#include <algorithm>
+
+using namespace lox;
+
+namespace {
+    // Kernels are plain loops writing to a restrict-qualified array so the
+    // compiler turns each of them into SIMD code (this file is built with
+    // -O3). A null input array stands for a column where every row holds the
+    // same value, which is how literals take part without being broadcast.
+
+    template <typename T, typename Out, typename Op>
+    void binaryKernel(const T* a, T aValue, const T* b, T bValue,
+                      Out* __restrict out, size_t n, Op op) {
+        if (a == nullptr) {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = op(aValue, b[i]);
+        } else if (b == nullptr) {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = op(a[i], bValue);
+        } else {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = op(a[i], b[i]);
+        }
+    }
+
+    void negateKernel(const double* __restrict a, double* __restrict out,
+                      size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = -a[i];
+    }
+
+    void notKernel(const uint8_t* __restrict a, uint8_t* __restrict out,
+                   size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = a[i] ^ 1;
+    }
+
+    struct Add {
+        double operator()(double a, double b) const {
+            return a + b;
+        }
+    };
+    struct Subtract {
+        double operator()(double a, double b) const {
+            return a - b;
+        }
+    };
+    struct Multiply {
+        double operator()(double a, double b) const {
+            return a * b;
+        }
+    };
+    struct Divide {
+        double operator()(double a, double b) const {
+            return a / b;
+        }
+    };
+    struct Greater {
+        uint8_t operator()(double a, double b) const {
+            return a > b;
+        }
+    };
+    struct GreaterEqual {
+        uint8_t operator()(double a, double b) const {
+            return a >= b;
+        }
+    };
+    struct Less {
+        uint8_t operator()(double a, double b) const {
+            return a < b;
+        }
+    };
+    struct LessEqual {
+        uint8_t operator()(double a, double b) const {
+            return a <= b;
+        }
+    };
+    struct Equal {
+        template <typename T>
+        uint8_t operator()(T a, T b) const {
+            return a == b;
+        }
+    };
+    struct NotEqual {
+        template <typename T>
+        uint8_t operator()(T a, T b) const {
+            return a != b;
+        }
+    };
+} // namespace
+
+constexpr size_t BatchEvaluator::noScratch;
+constexpr size_t BatchEvaluator::chunkSize;
+
+BatchEvaluator::View BatchEvaluator::View::numberConstant(double value) {
+    return {Column::Type::NUMBER, nullptr, nullptr, value, 0, noScratch};
+}
+
+BatchEvaluator::View BatchEvaluator::View::boolConstant(bool value) {
+    return {Column::Type::BOOL, nullptr, nullptr, 0, value, noScratch};
+}
+
+BatchEvaluator::View BatchEvaluator::View::numberValues(const double* values,
+                                                        size_t scratch) {
+    return {Column::Type::NUMBER, values, nullptr, 0, 0, scratch};
+}
+
+BatchEvaluator::View BatchEvaluator::View::boolValues(const uint8_t* values,
+                                                      size_t scratch) {
+    return {Column::Type::BOOL, nullptr, values, 0, 0, scratch};
+}
+
+bool BatchEvaluator::View::constant() const {
+    return numbers == nullptr && bools == nullptr;
+}
+
+BatchEvaluator::BatchEvaluator(const ColumnSet& columns, Mode mode)
+    : columns_(columns)
+    , mode_(mode)
+    , chunkBegin_(0)
+    , chunkRows_(0) {}
+
+Column BatchEvaluator::evaluate(Expr* expr, size_t rowCount) {
+    Column output = Column::numbers({});
+    for (chunkBegin_ = 0; chunkBegin_ < rowCount; chunkBegin_ += chunkSize) {
+        chunkRows_ = std::min(chunkSize, rowCount - chunkBegin_);
+        // nothing is alive between chunks, every buffer can be handed out
+        // again
+        freeScratch_.clear();
+        for (size_t index = scratch_.size(); index-- > 0;)
+            freeScratch_.push_back(index);
+        const View chunk = evaluateChunk(expr);
+        if (chunkBegin_ == 0) {
+            output.type = chunk.type;
+            if (chunk.type == Column::Type::NUMBER) {
+                output.numberValues.reserve(rowCount);
+            } else {
+                output.boolValues.reserve(rowCount);
+            }
+        } else if (chunk.type != output.type) {
+            throw RuntimeError("Expression does not have a single type.");
+        }
+        if (chunk.type == Column::Type::NUMBER) {
+            auto& values = output.numberValues;
+            if (chunk.constant()) {
+                values.insert(values.end(), chunkRows_, chunk.number);
+            } else {
+                values.insert(values.end(), chunk.numbers,
+                              chunk.numbers + chunkRows_);
+            }
+        } else {
+            auto& values = output.boolValues;
+            if (chunk.constant()) {
+                values.insert(values.end(), chunkRows_, chunk.boolean);
+            } else {
+                values.insert(values.end(), chunk.bools,
+                              chunk.bools + chunkRows_);
+            }
+        }
+    }
+    return output;
+}
+
+BatchEvaluator::View BatchEvaluator::evaluateChunk(Expr* expr) {
+    if (mode_ == Mode::RECURSIVE) {
+        expr->accept(this);
+        return result_;
+    }
+    // a throw may have left the previous chunk half done
+    pending_.clear();
+    values_.clear();
+    pending_.push_back({expr, nullptr, false});
+    while (!pending_.empty()) {
+        const WorkItem item = pending_.back();
+        pending_.pop_back();
+        if (item.expr != nullptr) {
+            item.expr->accept(this);
+            continue;
+        }
+        // operands were pushed left first
+        const View right = values_.back();
+        values_.pop_back();
+        if (!item.binary) {
+            values_.push_back(combineUnary(*item.op, right));
+            continue;
+        }
+        const View left = values_.back();
+        values_.pop_back();
+        values_.push_back(combineBinary(*item.op, left, right));
+    }
+    return values_.back();
+}
+
+void BatchEvaluator::produce(const View& view) {
+    if (mode_ == Mode::RECURSIVE) {
+        result_ = view;
+    } else {
+        values_.push_back(view);
+    }
+}
+
+BatchEvaluator::View BatchEvaluator::combineBinary(const Token& op,
+                                                   const View& left,
+                                                   const View& right) {
+    const auto type = op.type;
+    // equality is defined between any two values, values of different types
+    // are never equal
+    if (type == TokenType::EQUAL_EQUAL || type == TokenType::BANG_EQUAL) {
+        const bool equal = type == TokenType::EQUAL_EQUAL;
+        if (left.type != right.type) {
+            release(left);
+            release(right);
+            return View::boolConstant(!equal);
+        }
+        if (equal)
+            return comparison(left, right, Equal());
+        return comparison(left, right, NotEqual());
+    }
+    if (left.type != Column::Type::NUMBER ||
+        right.type != Column::Type::NUMBER) {
+        throw RuntimeError("Operands of '" + op.lexeme +
+                           "' must be numbers.");
+    }
+    switch (type) {
+        case TokenType::PLUS:
+            return arithmetic(left, right, Add());
+        case TokenType::MINUS:
+            return arithmetic(left, right, Subtract());
+        case TokenType::STAR:
+            return arithmetic(left, right, Multiply());
+        case TokenType::SLASH:
+            return arithmetic(left, right, Divide());
+        case TokenType::GREATER:
+            return comparison(left, right, Greater());
+        case TokenType::GREATER_EQUAL:
+            return comparison(left, right, GreaterEqual());
+        case TokenType::LESS:
+            return comparison(left, right, Less());
+        case TokenType::LESS_EQUAL:
+            return comparison(left, right, LessEqual());
+        default:
+            throw RuntimeError("Unsupported operator '" + op.lexeme + "'.");
+    }
+}
+
+BatchEvaluator::View BatchEvaluator::combineUnary(const Token& op,
+                                                  const View& right) {
+    if (op.type == TokenType::MINUS) {
+        if (right.type != Column::Type::NUMBER)
+            throw RuntimeError("Operand of '-' must be a number.");
+        if (right.constant())
+            return View::numberConstant(-right.number);
+        const size_t index = acquireScratch();
+        double* out        = numberScratch(index);
+        negateKernel(right.numbers, out, chunkRows_);
+        release(right);
+        return View::numberValues(out, index);
+    }
+    // numbers are always truthy
+    if (right.type == Column::Type::NUMBER) {
+        release(right);
+        return View::boolConstant(false);
+    }
+    if (right.constant())
+        return View::boolConstant(!right.boolean);
+    const size_t index = acquireScratch();
+    uint8_t* out       = boolScratch(index);
+    notKernel(right.bools, out, chunkRows_);
+    release(right);
+    return View::boolValues(out, index);
+}
+
+template <typename Op>
+BatchEvaluator::View BatchEvaluator::arithmetic(const View& left,
+                                                const View& right, Op op) {
+    if (left.constant() && right.constant())
+        return View::numberConstant(op(left.number, right.number));
+    // the output buffer is taken before the inputs are released so it never
+    // aliases them
+    const size_t index = acquireScratch();
+    double* out        = numberScratch(index);
+    binaryKernel(left.numbers, left.number, right.numbers, right.number, out,
+                 chunkRows_, op);
+    release(left);
+    release(right);
+    return View::numberValues(out, index);
+}
+
+template <typename Op>
+BatchEvaluator::View BatchEvaluator::comparison(const View& left,
+                                                const View& right, Op op) {
+    const bool numbers = left.type == Column::Type::NUMBER;
+    if (left.constant() && right.constant()) {
+        return View::boolConstant(numbers
+                                      ? op(left.number, right.number)
+                                      : op(left.boolean, right.boolean));
+    }
+    const size_t index = acquireScratch();
+    uint8_t* out       = boolScratch(index);
+    if (numbers) {
+        binaryKernel(left.numbers, left.number, right.numbers, right.number,
+                     out, chunkRows_, op);
+    } else {
+        binaryKernel(left.bools, left.boolean, right.bools, right.boolean,
+                     out, chunkRows_, op);
+    }
+    release(left);
+    release(right);
+    return View::boolValues(out, index);
+}
+
+size_t BatchEvaluator::acquireScratch() {
+    if (freeScratch_.empty()) {
+        scratch_.emplace_back();
+        return scratch_.size() - 1;
+    }
+    const size_t index = freeScratch_.back();
+    freeScratch_.pop_back();
+    return index;
+}
+
+void BatchEvaluator::release(const View& view) {
+    if (view.scratch != noScratch)
+        freeScratch_.push_back(view.scratch);
+}
+
+double* BatchEvaluator::numberScratch(size_t index) {
+    // buffers only grow once, moving scratch_ around keeps their data put
+    auto& values = scratch_[index].numbers;
+    if (values.empty())
+        values.resize(chunkSize);
+    return values.data();
+}
+
+uint8_t* BatchEvaluator::boolScratch(size_t index) {
+    auto& values = scratch_[index].bools;
+    if (values.empty())
+        values.resize(chunkSize);
+    return values.data();
+}
+
+void BatchEvaluator::visitBinaryExpr(BinaryExpr* expr) {
+    if (mode_ == Mode::ITERATIVE) {
+        // the operator runs once both operands are done
+        pending_.push_back({nullptr, &expr->Operator, true});
+        pending_.push_back({expr->right, nullptr, false});
+        pending_.push_back({expr->left, nullptr, false});
+        return;
+    }
+    const View left  = evaluateChunk(expr->left);
+    const View right = evaluateChunk(expr->right);
+    result_          = combineBinary(expr->Operator, left, right);
+}
+
+void BatchEvaluator::visitGroupingExpr(GroupingExpr* expr) {
+    if (mode_ == Mode::ITERATIVE)
+        return pending_.push_back({expr->expression, nullptr, false});
+    expr->expression->accept(this);
+}
+
+void BatchEvaluator::visitLiteralExpr(LiteralExpr* expr) {
+    const Literal& literal = expr->value;
+    if (literal.type == Literal::Type::BOOL) {
+        produce(View::boolConstant(literal.boolValue));
+    } else if (literal.type == Literal::Type::NUMBER) {
+        produce(View::numberConstant(literal.numberValue));
+    } else {
+        throw RuntimeError("Unsupported literal '" + literal.toString() +
+                           "', only numbers and booleans can be evaluated.");
+    }
+}
+
+void BatchEvaluator::visitUnaryExpr(UnaryExpr* expr) {
+    if (mode_ == Mode::ITERATIVE) {
+        pending_.push_back({nullptr, &expr->Operator, false});
+        pending_.push_back({expr->right, nullptr, false});
+        return;
+    }
+    const View right = evaluateChunk(expr->right);
+    result_          = combineUnary(expr->Operator, right);
+}
+
+void BatchEvaluator::visitVariableExpr(VariableExpr* expr) {
+    const auto column = columns_.find(expr->name.lexeme);
+    if (column == columns_.end()) {
+        throw RuntimeError("Undefined variable '" + expr->name.lexeme + "'.");
+    }
+    const Column& input = column->second;
+    if (input.size() < chunkBegin_ + chunkRows_) {
+        throw RuntimeError("Column '" + expr->name.lexeme +
+                           "' has fewer rows than requested.");
+    }
+    // the input is read in place
+    if (input.type == Column::Type::NUMBER) {
+        produce(View::numberValues(input.numberValues.data() + chunkBegin_,
+                                   noScratch));
+    } else {
+        produce(View::boolValues(input.boolValues.data() + chunkBegin_,
+                                 noScratch));
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef BATCH_EVALUATOR_HPP
+#define BATCH_EVALUATOR_HPP
+
+#include "../Expr.hpp"
+#include "column.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lox {
+    /// @brief evaluates a parsed expression over whole columns at once
+    /// instead of walking the tree once per row. Variables in the expression
+    /// are bound to the input columns by name.
+    class BatchEvaluator : public ExprVisitor {
+      public:
+        using ColumnSet = lox::ColumnSet;
+        /// @brief RECURSIVE evaluates children through nested accept calls.
+        /// ITERATIVE queues them on a heap-allocated work stack instead so
+        /// that arbitrarily deep trees can be evaluated.
+        enum class Mode { RECURSIVE, ITERATIVE };
+        BatchEvaluator(const ColumnSet& columns,
+                       Mode mode = Mode::RECURSIVE);
+        /// @brief evaluates expr for rows [0, rowCount) and returns the
+        /// result column. Throws RuntimeError on type errors or unbound
+        /// variables.
+        Column evaluate(Expr* expr, size_t rowCount);
+        void visitBinaryExpr(BinaryExpr* expr) override;
+        void visitGroupingExpr(GroupingExpr* expr) override;
+        void visitLiteralExpr(LiteralExpr* expr) override;
+        void visitUnaryExpr(UnaryExpr* expr) override;
+        void visitVariableExpr(VariableExpr* expr) override;
+
+      private:
+        /// @brief values of an expression for the rows of the current chunk.
+        /// Points either into an input column or into a scratch buffer, so
+        /// no values are copied to pass a result up the tree. Literals and
+        /// anything computed from literals alone have the same value in
+        /// every row and aren't stored in a buffer at all.
+        struct View {
+            static View numberConstant(double value);
+            static View boolConstant(bool value);
+            static View numberValues(const double* values, size_t scratch);
+            static View boolValues(const uint8_t* values, size_t scratch);
+            bool constant() const;
+            Column::Type type;
+            /// @brief values per row, null for constants
+            const double* numbers;
+            const uint8_t* bools;
+            /// @brief the value of a constant
+            double number;
+            uint8_t boolean;
+            /// @brief index of the scratch buffer holding the values, or
+            /// noScratch if they belong to someone else
+            size_t scratch;
+        };
+        /// @brief intermediate values of one node, chunkSize rows long
+        struct Scratch {
+            std::vector<double> numbers;
+            std::vector<uint8_t> bools;
+        };
+        /// @brief either an expression to visit or an operator to apply to
+        /// the values its operands left on values_
+        struct WorkItem {
+            Expr* expr;
+            const Token* op;
+            bool binary;
+        };
+        static constexpr size_t noScratch = SIZE_MAX;
+
+        /// @brief evaluates expr for the current chunk of rows
+        View evaluateChunk(Expr* expr);
+        /// @brief hands a visited expression's values to whoever uses them
+        void produce(const View& view);
+        /// @brief applies op to operands that were already evaluated and
+        /// releases their buffers
+        View combineBinary(const Token& op, const View& left,
+                           const View& right);
+        View combineUnary(const Token& op, const View& right);
+        template <typename Op>
+        View arithmetic(const View& left, const View& right, Op op);
+        template <typename Op>
+        View comparison(const View& left, const View& right, Op op);
+        /// @brief buffers are handed out from a free list and returned as
+        /// soon as their values are consumed, so they are allocated once per
+        /// evaluate call and then reused for every chunk
+        size_t acquireScratch();
+        void release(const View& view);
+        double* numberScratch(size_t index);
+        uint8_t* boolScratch(size_t index);
+
+        /// @brief rows are processed in chunks so that intermediate columns
+        /// stay in cache while the tree is walked
+        static constexpr size_t chunkSize = 4096;
+        const ColumnSet& columns_;
+        Mode mode_;
+        /// @brief first row and number of rows of the chunk being evaluated
+        size_t chunkBegin_;
+        size_t chunkRows_;
+        /// @brief result of the last visited expression (RECURSIVE)
+        View result_;
+        /// @brief work stack and the values of evaluated operands that
+        /// wait for their operator (ITERATIVE)
+        std::vector<WorkItem> pending_;
+        std::vector<View> values_;
+        std::vector<Scratch> scratch_;
+        std::vector<size_t> freeScratch_;
+    };
+} // namespace lox
+
+#endif // BATCH_EVALUATOR_HPP
@@ -0,0 +1,25 @@
+#include "column.hpp"
+#include <utility>
+
+using namespace lox;
+
+Column Column::numbers(std::vector<double> values) {
+    Column column;
+    column.type         = Type::NUMBER;
+    column.numberValues = std::move(values);
+    return column;
+}
+
+Column Column::bools(std::vector<uint8_t> values) {
+    Column column;
+    column.type       = Type::BOOL;
+    column.boolValues = std::move(values);
+    return column;
+}
+
+size_t Column::size() const {
+    return type == Type::NUMBER ? numberValues.size() : boolValues.size();
+}
+
+RuntimeError::RuntimeError(std::string msg)
+    : std::runtime_error(msg) {}
@@ -0,0 +1,37 @@
+#ifndef COLUMN_HPP
+#define COLUMN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lox {
+    /// @brief a typed column of values, one value per input row. Only
+    /// numbers and booleans are supported since those are the only types
+    /// that map onto flat arrays.
+    class Column {
+      public:
+        enum class Type { NUMBER, BOOL };
+        static Column numbers(std::vector<double> values);
+        static Column bools(std::vector<uint8_t> values);
+        size_t size() const;
+        Type type;
+        std::vector<double> numberValues;
+        /// @brief 0 or 1 per row (std::vector<bool> is bit-packed which
+        /// defeats vectorization)
+        std::vector<uint8_t> boolValues;
+    };
+
+    /// @brief input columns by variable name
+    using ColumnSet = std::unordered_map<std::string, Column>;
+
+    class RuntimeError : public std::runtime_error {
+      public:
+        RuntimeError(std::string msg);
+    };
+} // namespace lox
+
+#endif // COLUMN_HPP
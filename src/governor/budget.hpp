@@ -0,0 +1,50 @@
+#ifndef BUDGET_HPP
+#define BUDGET_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+namespace lox {
+    /// @brief limits for one scan and parse job, for callers that can't trust
+    /// their input. Scanner and Parser take an optional pointer to one and
+    /// stop with a "Resource limit exceeded" error once a limit is hit. Token
+    /// and node counts are checked exactly, the clock and the cancel flag
+    /// only every checkInterval lexemes, characters inside lexemes or nodes.
+    struct Budget {
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+        /// @brief lexemes, characters or nodes between two looks at the
+        /// clock
+        static constexpr size_t checkInterval = 1024;
+
+        Clock::time_point deadline = Clock::time_point::max();
+        size_t maxTokens           = unlimited;
+        size_t maxNodes            = unlimited;
+        /// @brief how deep parentheses and prefix operators may nest
+        size_t maxDepth = unlimited;
+        /// @brief set by another thread to stop the job, may be null
+        const std::atomic<bool>* cancel = nullptr;
+
+        /// @brief budget whose deadline is timeout from now
+        template <typename Duration>
+        static Budget withTimeout(Duration timeout) {
+            Budget budget;
+            budget.deadline = Clock::now() + timeout;
+            return budget;
+        }
+        /// @brief why the job has to stop regardless of its progress, or
+        /// nullptr if it may go on
+        const char* interrupted() const {
+            if (cancel != nullptr && cancel->load(std::memory_order_relaxed))
+                return "job cancelled";
+            if (deadline != Clock::time_point::max() && Clock::now() > deadline)
+                return "deadline passed";
+            return nullptr;
+        }
+    };
+} // namespace lox
+
+#endif // BUDGET_HPP
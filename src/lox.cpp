@@ -0,0 +1,61 @@
+#include "lox.hpp"
+#include "error_handler/error_handler.hpp"
+#include "evaluator/batch_evaluator.hpp"
+#include "parser/parser.hpp"
+#include "scanner/scanner.hpp"
+#include "tools/ast_deleter.hpp"
+#include "tools/ast_printer.hpp"
+#include <sstream>
+
+using namespace lox;
+
+CompileError::CompileError(std::string diagnostics)
+    : std::runtime_error(diagnostics) {}
+
+CompiledExpr::CompiledExpr(const std::string& source)
+    : source_(source)
+    , root_(nullptr) {}
+
+CompiledExpr::~CompiledExpr() {
+    ASTDeleter deleter;
+    deleter.destroy(root_);
+}
+
+std::string CompiledExpr::print() const {
+    // printers and evaluators keep their state in themselves, so every call
+    // gets its own and the shared tree is only read
+    std::ostringstream out;
+    ASTPrinter printer(ASTPrinter::Mode::ITERATIVE, out);
+    printer.print(root_);
+    return out.str();
+}
+
+Column CompiledExpr::evaluate(const ColumnSet& columns,
+                              size_t rowCount) const {
+    // compile accepts any depth, so neither pass may recurse
+    BatchEvaluator evaluator(columns, BatchEvaluator::Mode::ITERATIVE);
+    return evaluator.evaluate(root_, rowCount);
+}
+
+const std::string& CompiledExpr::source() const {
+    return source_;
+}
+
+std::shared_ptr<const CompiledExpr> lox::compile(const std::string& source,
+                                                 const Budget* budget) {
+    std::shared_ptr<CompiledExpr> compiled(new CompiledExpr(source));
+    // the parser reports as soon as it fails, keep that off stdout
+    std::ostream discard(nullptr);
+    ErrorHandler errorHandler(discard);
+    errorHandler.setSource(compiled->source_);
+    Scanner scanner(compiled->source_, errorHandler, budget);
+    const auto tokens = scanner.scanAndGetTokens();
+    if (!errorHandler.foundError) {
+        // iterative so that any nesting depth the budget allows is fine
+        Parser parser(tokens, errorHandler, Parser::Mode::ITERATIVE, budget);
+        compiled->root_ = parser.parse();
+    }
+    if (errorHandler.foundError)
+        throw CompileError(errorHandler.toString());
+    return compiled;
+}
@@ -0,0 +1,57 @@
+#ifndef LOX_HPP
+#define LOX_HPP
+
+#include "evaluator/column.hpp"
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// forward declarations, the generated AST classes stay out of the API so
+// that it doesn't change with the build mode (see PROFILE in the Makefile)
+class Expr;
+
+namespace lox {
+    // forward declarations
+    struct Budget;
+
+    /// @brief thrown by compile for sources that don't scan or parse
+    class CompileError : public std::runtime_error {
+      public:
+        /// @brief diagnostics is the text ErrorHandler would have reported
+        CompileError(std::string diagnostics);
+    };
+
+    /// @brief a parsed expression together with everything it refers to.
+    /// It never changes after compile, so one instance can be printed and
+    /// evaluated any number of times from any number of threads at once.
+    class CompiledExpr {
+      public:
+        ~CompiledExpr();
+        CompiledExpr(const CompiledExpr&) = delete;
+        CompiledExpr& operator=(const CompiledExpr&) = delete;
+        /// @brief the text ASTPrinter prints for the tree
+        std::string print() const;
+        /// @brief evaluates the expression over rows [0, rowCount) of
+        /// columns, see BatchEvaluator. Throws RuntimeError.
+        Column evaluate(const ColumnSet& columns, size_t rowCount) const;
+        const std::string& source() const;
+
+      private:
+        friend std::shared_ptr<const CompiledExpr>
+        compile(const std::string& source, const Budget* budget);
+        CompiledExpr(const std::string& source);
+
+        /// @brief the token offsets in the tree refer to this copy
+        const std::string source_;
+        /// @brief owned, freed with ASTDeleter
+        Expr* root_;
+    };
+
+    /// @brief scans and parses source once. Nothing is printed, errors
+    /// (including an exceeded budget) are thrown as a CompileError.
+    std::shared_ptr<const CompiledExpr>
+    compile(const std::string& source, const Budget* budget = nullptr);
+} // namespace lox
+
+#endif // LOX_HPP
@@ -2,14 +2,27 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "error_handler/error_handler.hpp"
 #include "parser/parser.hpp"
+#include "pipeline/pipeline.hpp"
+#include "profiler/profiler.hpp"
 #include "scanner/scanner.hpp"
+#include "tools/ast_deleter.hpp"
 #include "tools/ast_printer.hpp"
 
 namespace lox {
-    static void run(const std::string& source, ErrorHandler& errorHandler) {
+    /// @brief set by --profile, prints visit counts and cycles per node kind
+    /// and the hottest source locations after every run. Every pass over the
+    /// tree is counted, freeing it included.
+    static bool profile = false;
+
+    /// @brief deep mode parses and prints with explicit heap stacks, used for
+    /// files since those may be machine generated and arbitrarily nested
+    static void run(const std::string& source, ErrorHandler& errorHandler,
+                    bool deep = false) {
+        errorHandler.setSource(source);
         /// scanner
         Scanner scanner(source, errorHandler);
         const auto tokens = scanner.scanAndGetTokens();
@@ -19,7 +32,8 @@ namespace lox {
             return;
         }
         /// parser
-        Parser parser(tokens, errorHandler);
+        Parser parser(tokens, errorHandler,
+                      deep ? Parser::Mode::ITERATIVE : Parser::Mode::RECURSIVE);
         auto expr = parser.parse();
         // if found error during parsing, report
         if (errorHandler.foundError) {
@@ -27,17 +41,45 @@ namespace lox {
             return;
         }
         /// print ast
-        ASTPrinter pp;
+#ifdef LOX_INSTRUMENTED
+        if (profile)
+            profiler::reset();
+#endif
+        ASTPrinter pp(deep ? ASTPrinter::Mode::ITERATIVE
+                           : ASTPrinter::Mode::RECURSIVE);
         pp.print(expr);
         std::cout << std::endl;
+        ASTDeleter deleter;
+        deleter.destroy(expr);
+#ifdef LOX_INSTRUMENTED
+        if (profile)
+            profiler::report(std::cout, source);
+#endif
     }
 
-    static void runFile(const std::string& path, ErrorHandler& errorHandler) {
+    /// @brief pipelined runs every ';' separated expression of the file with
+    /// scanning, parsing and printing overlapped on separate threads
+    static void runFile(const std::string& path, ErrorHandler& errorHandler,
+                        bool pipelined) {
         std::ifstream file(path);
         std::ostringstream stream;
         stream << file.rdbuf();
         file.close();
-        run(stream.str(), errorHandler);
+        const std::string source = stream.str();
+        if (pipelined) {
+#ifdef LOX_INSTRUMENTED
+            if (profile)
+                profiler::reset();
+#endif
+            Pipeline pipeline(source, errorHandler, std::cout);
+            pipeline.run();
+#ifdef LOX_INSTRUMENTED
+            if (profile)
+                profiler::report(std::cout, source);
+#endif
+        } else {
+            run(source, errorHandler, true);
+        }
     }
 
     static void runPrompt(ErrorHandler& errorHandler) {
@@ -55,10 +97,31 @@ namespace lox {
 
 int main(int argc, char** argv) {
     lox::ErrorHandler errorHandler;
-    if (argc > 2) {
-        std::cout << "Usage: lox [filename]" << std::endl;
-    } else if (argc == 2) {
-        lox::runFile(argv[1], errorHandler);
+    bool pipelined = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--pipeline") {
+            pipelined = true;
+        } else if (arg == "--profile") {
+            lox::profile = true;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+#ifndef LOX_INSTRUMENTED
+    if (lox::profile) {
+        std::cout << "--profile needs an instrumented build, rebuild with "
+                     "`make PROFILE=1`"
+                  << std::endl;
+        return 1;
+    }
+#endif
+    if (paths.size() > 1 || (pipelined && paths.empty())) {
+        std::cout << "Usage: lox [--profile] [--pipeline filename | filename]"
+                  << std::endl;
+    } else if (paths.size() == 1) {
+        lox::runFile(paths[0], errorHandler, pipelined);
     } else {
         lox::runPrompt(errorHandler);
     }
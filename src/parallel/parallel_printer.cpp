@@ -0,0 +1,121 @@
+#include "parallel_printer.hpp"
+#include "../tools/ast_printer.hpp"
+#include "../tools/subtree_sizes.hpp"
+#include <sstream>
+
+using namespace lox;
+
+namespace {
+    /// @brief the text ASTPrinter opens a node with and the node's children,
+    /// no children for leaves
+    class NodeShape : public ExprVisitor {
+      public:
+        void describe(Expr* expr) {
+            open.clear();
+            children.clear();
+            expr->accept(this);
+        }
+        void visitBinaryExpr(BinaryExpr* expr) override {
+            open     = "(" + expr->Operator.lexeme;
+            children = {expr->left, expr->right};
+        }
+        void visitGroupingExpr(GroupingExpr* expr) override {
+            open     = "(group";
+            children = {expr->expression};
+        }
+        void visitLiteralExpr(LiteralExpr* expr) override {}
+        void visitUnaryExpr(UnaryExpr* expr) override {
+            open     = "(" + expr->Operator.lexeme;
+            children = {expr->right};
+        }
+        void visitVariableExpr(VariableExpr* expr) override {}
+        std::string open;
+        std::vector<Expr*> children;
+    };
+
+    /// @brief prints small subtrees with ASTPrinter, reusing one stream
+    /// since most of them are tiny
+    class SequentialPrinter {
+      public:
+        SequentialPrinter()
+            : printer_(ASTPrinter::Mode::ITERATIVE, out_) {}
+        std::string print(Expr* expr) {
+            out_.str("");
+            printer_.print(expr);
+            return out_.str();
+        }
+
+      private:
+        std::ostringstream out_;
+        ASTPrinter printer_;
+    };
+} // namespace
+
+ParallelPrinter::ParallelPrinter(WorkStealingPool& pool,
+                                 const SubtreeSizes& sizes, size_t threshold)
+    : pool_(pool)
+    , sizes_(sizes)
+    , threshold_(threshold) {}
+
+std::string ParallelPrinter::print(Expr* expr) const {
+    return printSubtree(expr, 0);
+}
+
+std::string ParallelPrinter::printSubtree(Expr* expr, size_t index) const {
+    SequentialPrinter sequential;
+    // without a split into two large parts nothing below expr gets forked
+    if (sizes_.largestSplit(index) < threshold_)
+        return sequential.print(expr);
+    // output is every part of before in order, then every part of after in
+    // reverse order
+    std::vector<Part> before;
+    std::vector<Part> after;
+    NodeShape shape;
+    // small subtrees are printed right away, large ones are forked
+    auto makePart = [&](Expr* subtree, size_t at) -> Part {
+        if (sizes_.of(at) < threshold_)
+            return {sequential.print(subtree), nullptr, nullptr};
+        auto result = std::make_shared<std::string>();
+        auto task   = pool_.submit([this, subtree, at, result]() {
+            *result = printSubtree(subtree, at);
+        });
+        return {"", task, result};
+    };
+    while (sizes_.largestSplit(index) >= threshold_) {
+        shape.describe(expr);
+        before.push_back({shape.open, nullptr, nullptr});
+        after.push_back({")", nullptr, nullptr});
+        const size_t first = index + 1;
+        if (shape.children.size() == 1) {
+            expr  = shape.children[0];
+            index = first;
+            continue;
+        }
+        const size_t second = first + sizes_.of(first);
+        if (sizes_.of(first) >= sizes_.of(second)) {
+            after.push_back(makePart(shape.children[1], second));
+            expr  = shape.children[0];
+            index = first;
+        } else {
+            before.push_back(makePart(shape.children[0], first));
+            expr  = shape.children[1];
+            index = second;
+        }
+    }
+    before.push_back({sequential.print(expr), nullptr, nullptr});
+    std::string out;
+    for (const auto& part : before)
+        append(out, part);
+    for (auto it = after.rbegin(); it != after.rend(); ++it)
+        append(out, *it);
+    return out;
+}
+
+void ParallelPrinter::append(std::string& out, const Part& part) const {
+    if (part.task) {
+        pool_.wait(part.task);
+        out += *part.result;
+    } else {
+        out += part.text;
+    }
+}
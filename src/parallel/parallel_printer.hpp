@@ -0,0 +1,46 @@
+#ifndef PARALLEL_PRINTER_HPP
+#define PARALLEL_PRINTER_HPP
+
+#include "../Expr.hpp"
+#include "work_stealing_pool.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lox {
+    // forward declarations
+    class SubtreeSizes;
+
+    /// @brief prints the same text as ASTPrinter, forking subtrees with at
+    /// least threshold nodes onto a WorkStealingPool. Every subtree is
+    /// printed into its own string and the pieces are joined in tree order,
+    /// so the output doesn't depend on scheduling.
+    class ParallelPrinter {
+      public:
+        /// @brief sizes must have been computed for the tree to print
+        ParallelPrinter(WorkStealingPool& pool, const SubtreeSizes& sizes,
+                        size_t threshold = 4096);
+        std::string print(Expr* expr) const;
+
+      private:
+        /// @brief a piece of output: either text or a forked subtree
+        struct Part {
+            std::string text;
+            WorkStealingPool::TaskHandle task;
+            std::shared_ptr<std::string> result;
+        };
+        /// @brief walks down the larger child of every large node in a loop
+        /// (so long chains don't recurse) and forks or prints the other one.
+        /// Subtrees that can't be split into two large parts are printed
+        /// sequentially. index is the pre-order index of expr in sizes_.
+        std::string printSubtree(Expr* expr, size_t index) const;
+        void append(std::string& out, const Part& part) const;
+
+        WorkStealingPool& pool_;
+        const SubtreeSizes& sizes_;
+        const size_t threshold_;
+    };
+} // namespace lox
+
+#endif // PARALLEL_PRINTER_HPP
@@ -0,0 +1,110 @@
+#include "work_stealing_pool.hpp"
+#include <utility>
+
+using namespace lox;
+
+namespace {
+    /// @brief pool and queue owned by the current worker thread
+    thread_local const WorkStealingPool* currentPool = nullptr;
+    thread_local size_t currentIndex                 = 0;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t threadCount)
+    : stopping_(false)
+    , queued_(0) {
+    if (threadCount == 0)
+        threadCount = 1;
+    for (size_t i = 0; i < threadCount; ++i)
+        queues_.emplace_back(new Queue());
+    for (size_t i = 1; i < threadCount; ++i)
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wakeUp_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+WorkStealingPool::TaskHandle
+WorkStealingPool::submit(std::function<void()> work) {
+    TaskHandle task = std::make_shared<Task>();
+    task->work      = std::move(work);
+    Queue& queue    = *queues_[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+    {
+        // taking the lock orders this with a worker about to go to sleep
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++queued_;
+    }
+    wakeUp_.notify_one();
+    return task;
+}
+
+void WorkStealingPool::wait(const TaskHandle& task) {
+    const size_t index = currentQueue();
+    while (!task->done.load(std::memory_order_acquire)) {
+        if (!runOne(index))
+            std::this_thread::yield();
+    }
+    if (task->error)
+        std::rethrow_exception(task->error);
+}
+
+size_t WorkStealingPool::threadCount() const {
+    return queues_.size();
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    currentPool  = this;
+    currentIndex = index;
+    while (!stopping_) {
+        if (runOne(index))
+            continue;
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeUp_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+    }
+}
+
+bool WorkStealingPool::runOne(size_t index) {
+    TaskHandle task;
+    {
+        Queue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+        }
+    }
+    for (size_t i = 1; !task && i < queues_.size(); ++i) {
+        Queue& victim = *queues_[(index + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task)
+        return false;
+    --queued_;
+    // an exception must not leave the task unfinished (its waiter would
+    // spin forever) nor end a worker thread, it is handed to the waiter
+    try {
+        task->work();
+    } catch (...) {
+        task->error = std::current_exception();
+    }
+    task->done.store(true, std::memory_order_release);
+    return true;
+}
+
+size_t WorkStealingPool::currentQueue() const {
+    return currentPool == this ? currentIndex : 0;
+}
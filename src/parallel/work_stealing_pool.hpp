@@ -0,0 +1,67 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lox {
+    /// @brief fork/join thread pool. Every thread owns a deque of tasks: it
+    /// pushes and pops its own tasks at the back (newest first) and steals
+    /// from the front of other deques (oldest, usually largest, first) when
+    /// its own is empty. Threads waiting for a task run other tasks
+    /// meanwhile, so nested fork/join never blocks the pool.
+    class WorkStealingPool {
+      public:
+        struct Task {
+            std::function<void()> work;
+            std::atomic<bool> done{false};
+            /// @brief what work threw, set before done
+            std::exception_ptr error;
+        };
+        using TaskHandle = std::shared_ptr<Task>;
+
+        /// @brief threadCount includes the thread calling wait(), so a pool
+        /// of 1 starts no threads and runs everything inside wait()
+        explicit WorkStealingPool(size_t threadCount);
+        ~WorkStealingPool();
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+        TaskHandle submit(std::function<void()> work);
+        /// @brief returns once task has run, running other tasks meanwhile.
+        /// Rethrows the exception the task threw, if any.
+        void wait(const TaskHandle& task);
+        size_t threadCount() const;
+
+      private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<TaskHandle> tasks;
+        };
+        void workerLoop(size_t index);
+        /// @brief runs one task from queue index or stolen from another
+        /// queue, returns false if there was nothing to run
+        bool runOne(size_t index);
+        /// @brief queue of the calling thread, 0 for threads outside the pool
+        size_t currentQueue() const;
+
+        /// @brief queue 0 is shared by threads outside the pool
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> workers_;
+        std::atomic<bool> stopping_;
+        /// @brief number of tasks sitting in queues, idle workers sleep while
+        /// it is 0
+        std::atomic<size_t> queued_;
+        std::mutex sleepMutex_;
+        std::condition_variable wakeUp_;
+    };
+} // namespace lox
+
+#endif // WORK_STEALING_POOL_HPP
@@ -0,0 +1,456 @@
+#ifndef EMBEDDED_EXPR_HPP
+#define EMBEDDED_EXPR_HPP
+
+#include "../Expr.hpp"
+#include "../scanner/char_class.hpp"
+#include "../scanner/token.hpp"
+#include <cstddef>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace lox {
+    /// @brief one node of an EmbeddedExpr, children refer to other nodes by
+    /// their index
+    struct EmbeddedNode {
+        enum class Kind { BINARY, GROUPING, LITERAL, UNARY, VARIABLE };
+        Kind kind = Kind::LITERAL;
+        /// @brief operator of BINARY and UNARY nodes, token type of LITERAL
+        /// nodes (NUMBER, STRING, TRUE, FALSE or NIL)
+        TokenType type = TokenType::NIL;
+        /// @brief BINARY uses both, GROUPING and UNARY only right
+        size_t left  = 0;
+        size_t right = 0;
+        /// @brief lexeme of the operator, literal or variable in source
+        size_t begin  = 0;
+        size_t length = 0;
+        /// @brief value of a NUMBER literal, decoded when the table is built
+        double number = 0;
+    };
+
+    /// @brief an expression parsed at compile time into a flat node table,
+    /// see embed(). N is the size of the source literal, which bounds the
+    /// number of nodes.
+    template <size_t N>
+    class EmbeddedExpr {
+      public:
+        char source[N]        = {};
+        EmbeddedNode nodes[N] = {};
+        size_t nodeCount      = 0;
+        size_t root           = 0;
+
+        /// @brief prints the same text as ASTPrinter does for the runtime
+        /// tree, without building it
+        void print(std::ostream& out) const {
+            print(out, root);
+        }
+        /// @brief builds the equivalent runtime tree
+        Expr* toExpr() const {
+            return toExpr(root);
+        }
+
+      private:
+        std::string_view lexeme(const EmbeddedNode& node) const {
+            return std::string_view(source + node.begin, node.length);
+        }
+        /// @brief same value the runtime scanner and parser give LiteralExpr
+        Literal literal(const EmbeddedNode& node) const {
+            switch (node.type) {
+                case TokenType::STRING:
+                    // trim the surrounding quotes
+                    return Literal::string(
+                        std::string(lexeme(node).substr(1, node.length - 2)));
+                case TokenType::TRUE:
+                    return Literal::boolean(true);
+                case TokenType::FALSE:
+                    return Literal::boolean(false);
+                case TokenType::NIL:
+                    return Literal();
+                default:
+                    return Literal::number(node.number);
+            }
+        }
+        void print(std::ostream& out, size_t index) const {
+            const EmbeddedNode& node = nodes[index];
+            switch (node.kind) {
+                case EmbeddedNode::Kind::BINARY:
+                    out << "(" << lexeme(node);
+                    print(out, node.left);
+                    print(out, node.right);
+                    out << ")";
+                    break;
+                case EmbeddedNode::Kind::GROUPING:
+                    out << "(group";
+                    print(out, node.right);
+                    out << ")";
+                    break;
+                case EmbeddedNode::Kind::LITERAL:
+                    out << " " << literal(node);
+                    break;
+                case EmbeddedNode::Kind::UNARY:
+                    out << "(" << lexeme(node);
+                    print(out, node.right);
+                    out << ")";
+                    break;
+                case EmbeddedNode::Kind::VARIABLE:
+                    out << " " << lexeme(node);
+                    break;
+            }
+        }
+        Token token(const EmbeddedNode& node, TokenType type) const {
+            return Token(type, std::string(lexeme(node)), Literal(),
+                         node.begin);
+        }
+        Expr* toExpr(size_t index) const {
+            const EmbeddedNode& node = nodes[index];
+            switch (node.kind) {
+                case EmbeddedNode::Kind::BINARY:
+                    return new BinaryExpr(toExpr(node.left),
+                                          token(node, node.type),
+                                          toExpr(node.right));
+                case EmbeddedNode::Kind::GROUPING:
+                    return new GroupingExpr(toExpr(node.right));
+                case EmbeddedNode::Kind::LITERAL:
+                    return new LiteralExpr(literal(node));
+                case EmbeddedNode::Kind::UNARY:
+                    return new UnaryExpr(token(node, node.type),
+                                         toExpr(node.right));
+                case EmbeddedNode::Kind::VARIABLE:
+                    return new VariableExpr(
+                        token(node, TokenType::IDENTIFIER));
+            }
+            return nullptr;
+        }
+    };
+
+    /// @brief constexpr counterpart of Scanner and Parser, same grammar.
+    /// A syntax error throws, which stops constant evaluation and turns into
+    /// a compile error whose trace names the message.
+    template <size_t N>
+    class EmbeddedParser {
+      public:
+        constexpr EmbeddedParser(const char (&text)[N])
+            : result()
+            , tokens()
+            , tokenCount(0)
+            , current(0) {
+            for (size_t i = 0; i < N; ++i)
+                result.source[i] = text[i];
+        }
+        constexpr EmbeddedExpr<N> parse() {
+            scan();
+            result.root = expression();
+            expect(peek().type == TokenType::END_OF_FILE,
+                   "Expect end of expression.");
+            return result;
+        }
+
+      private:
+        struct EmbeddedToken {
+            TokenType type = TokenType::END_OF_FILE;
+            size_t begin   = 0;
+            size_t length  = 0;
+        };
+
+        static constexpr void expect(bool condition, const char* message) {
+            if (!condition)
+                throw message;
+        }
+
+        /// @brief decodes a NUMBER lexeme (digits with an optional fraction)
+        /// to the same double Literal::parseNumber gives. from_chars isn't
+        /// constexpr, so this takes Clinger's fast path: with the trailing
+        /// zeros moved into the exponent, a significand of at most 2^53 and
+        /// a power of ten of at most 10^22 are both exact doubles, and one
+        /// multiplication or division of them is correctly rounded. Longer
+        /// literals are rejected rather than rounded twice.
+        static constexpr double decodeNumber(const char* digits,
+                                             size_t length) {
+            // significand without leading and trailing zeros, and the
+            // power of ten it is scaled by
+            unsigned long long significand = 0;
+            size_t significantDigits       = 0;
+            size_t pendingZeros            = 0;
+            int exponent                   = 0;
+            bool fraction                  = false;
+            for (size_t i = 0; i < length; ++i) {
+                if (digits[i] == '.') {
+                    fraction = true;
+                    continue;
+                }
+                if (fraction)
+                    --exponent;
+                const unsigned digit = digits[i] - '0';
+                if (digit == 0) {
+                    ++pendingZeros;
+                    continue;
+                }
+                if (significantDigits > 0) {
+                    significantDigits += pendingZeros;
+                    expect(significantDigits < 19,
+                           "Number literal has too many digits to decode "
+                           "at compile time.");
+                    for (; pendingZeros > 0; --pendingZeros)
+                        significand *= 10;
+                }
+                pendingZeros = 0;
+                significand  = significand * 10 + digit;
+                ++significantDigits;
+            }
+            exponent += static_cast<int>(pendingZeros);
+            if (significand == 0)
+                return 0;
+            constexpr unsigned long long maxExact = 1ull << 53;
+            constexpr int maxExactPower           = 22;
+            expect(significand <= maxExact && exponent <= maxExactPower &&
+                       exponent >= -maxExactPower,
+                   "Number literal has too many digits to decode at "
+                   "compile time.");
+            double power = 1;
+            for (int i = 0; i < exponent || i < -exponent; ++i)
+                power *= 10;
+            const double value = static_cast<double>(significand);
+            return exponent < 0 ? value / power : value * power;
+        }
+
+        /// scanner
+
+        constexpr void addToken(TokenType type, size_t begin, size_t end) {
+            tokens[tokenCount++] = {type, begin, end - begin};
+        }
+        constexpr void scan() {
+            const char* source  = result.source;
+            const size_t length = N - 1;
+            size_t index        = 0;
+            while (index < length) {
+                const size_t start = index;
+                const char c       = source[index++];
+                // second character of a two character operator
+                const bool equals = index < length && source[index] == '=';
+                switch (c) {
+                    case '(':
+                        addToken(TokenType::LEFT_PAREN, start, index);
+                        break;
+                    case ')':
+                        addToken(TokenType::RIGHT_PAREN, start, index);
+                        break;
+                    case '{':
+                        addToken(TokenType::LEFT_BRACE, start, index);
+                        break;
+                    case '}':
+                        addToken(TokenType::RIGHT_BRACE, start, index);
+                        break;
+                    case ',':
+                        addToken(TokenType::COMMA, start, index);
+                        break;
+                    case '.':
+                        addToken(TokenType::DOT, start, index);
+                        break;
+                    case '-':
+                        addToken(TokenType::MINUS, start, index);
+                        break;
+                    case '+':
+                        addToken(TokenType::PLUS, start, index);
+                        break;
+                    case ';':
+                        addToken(TokenType::SEMICOLON, start, index);
+                        break;
+                    case '*':
+                        addToken(TokenType::STAR, start, index);
+                        break;
+                    case '!':
+                        index += equals;
+                        addToken(equals ? TokenType::BANG_EQUAL
+                                        : TokenType::BANG,
+                                 start, index);
+                        break;
+                    case '=':
+                        index += equals;
+                        addToken(equals ? TokenType::EQUAL_EQUAL
+                                        : TokenType::EQUAL,
+                                 start, index);
+                        break;
+                    case '<':
+                        index += equals;
+                        addToken(equals ? TokenType::LESS_EQUAL
+                                        : TokenType::LESS,
+                                 start, index);
+                        break;
+                    case '>':
+                        index += equals;
+                        addToken(equals ? TokenType::GREATER_EQUAL
+                                        : TokenType::GREATER,
+                                 start, index);
+                        break;
+                    case '/':
+                        if (index < length && source[index] == '/') {
+                            // a comment goes until the end of the line.
+                            while (index < length && source[index] != '\n')
+                                ++index;
+                        } else {
+                            addToken(TokenType::SLASH, start, index);
+                        }
+                        break;
+                    case '"':
+                        while (index < length && source[index] != '"')
+                            ++index;
+                        expect(index < length, "Unterminated string.");
+                        // closing "
+                        ++index;
+                        addToken(TokenType::STRING, start, index);
+                        break;
+                    case ' ':
+                    case '\r':
+                    case '\t':
+                    case '\n':
+                        // ignore whitespace
+                        break;
+                    default:
+                        if (isDigit(c)) {
+                            while (index < length && isDigit(source[index]))
+                                ++index;
+                            // look for fractional part
+                            if (index + 1 < length && source[index] == '.' &&
+                                isDigit(source[index + 1])) {
+                                index += 2;
+                                while (index < length &&
+                                       isDigit(source[index]))
+                                    ++index;
+                            }
+                            addToken(TokenType::NUMBER, start, index);
+                        } else {
+                            expect(isAlpha(c), "Unexpected character.");
+                            while (index < length &&
+                                   isAlphaNumeric(source[index]))
+                                ++index;
+                            const std::string_view identifier(
+                                source + start, index - start);
+                            addToken(keywordType(identifier), start, index);
+                        }
+                }
+            }
+            addToken(TokenType::END_OF_FILE, length, length);
+        }
+
+        /// parser
+
+        constexpr size_t addNode(EmbeddedNode::Kind kind, TokenType type,
+                                 size_t left, size_t right,
+                                 const EmbeddedToken& token) {
+            EmbeddedNode& node = result.nodes[result.nodeCount];
+            node.kind          = kind;
+            node.type          = type;
+            node.left          = left;
+            node.right         = right;
+            node.begin         = token.begin;
+            node.length        = token.length;
+            if (type == TokenType::NUMBER)
+                node.number =
+                    decodeNumber(result.source + token.begin, token.length);
+            return result.nodeCount++;
+        }
+        constexpr size_t binary(size_t left, const EmbeddedToken& op,
+                                size_t right) {
+            return addNode(EmbeddedNode::Kind::BINARY, op.type, left, right,
+                           op);
+        }
+        constexpr size_t expression() {
+            return equality();
+        }
+        constexpr size_t equality() {
+            size_t expr = comparison();
+            while (match({TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL})) {
+                const EmbeddedToken op = previous();
+                expr                   = binary(expr, op, comparison());
+            }
+            return expr;
+        }
+        constexpr size_t comparison() {
+            size_t expr = term();
+            while (match({TokenType::GREATER, TokenType::LESS,
+                          TokenType::LESS_EQUAL})) {
+                const EmbeddedToken op = previous();
+                expr                   = binary(expr, op, term());
+            }
+            return expr;
+        }
+        constexpr size_t term() {
+            size_t expr = factor();
+            while (match({TokenType::MINUS, TokenType::PLUS})) {
+                const EmbeddedToken op = previous();
+                expr                   = binary(expr, op, factor());
+            }
+            return expr;
+        }
+        constexpr size_t factor() {
+            size_t expr = unary();
+            while (match({TokenType::SLASH, TokenType::STAR})) {
+                const EmbeddedToken op = previous();
+                expr                   = binary(expr, op, unary());
+            }
+            return expr;
+        }
+        constexpr size_t unary() {
+            if (match({TokenType::BANG, TokenType::MINUS})) {
+                const EmbeddedToken op = previous();
+                const size_t right     = unary();
+                return addNode(EmbeddedNode::Kind::UNARY, op.type, 0, right,
+                               op);
+            }
+            return primary();
+        }
+        constexpr size_t primary() {
+            if (match({TokenType::FALSE, TokenType::TRUE, TokenType::NIL,
+                       TokenType::NUMBER, TokenType::STRING})) {
+                return addNode(EmbeddedNode::Kind::LITERAL, previous().type, 0,
+                               0, previous());
+            }
+            if (match({TokenType::IDENTIFIER})) {
+                return addNode(EmbeddedNode::Kind::VARIABLE,
+                               TokenType::IDENTIFIER, 0, 0, previous());
+            }
+            expect(match({TokenType::LEFT_PAREN}), "Expect expression.");
+            const EmbeddedToken paren = previous();
+            const size_t expr         = expression();
+            expect(match({TokenType::RIGHT_PAREN}),
+                   "Exppect ')' after expression.");
+            return addNode(EmbeddedNode::Kind::GROUPING,
+                           TokenType::LEFT_PAREN, 0, expr, paren);
+        }
+        constexpr bool match(std::initializer_list<TokenType> types) {
+            for (const auto type : types) {
+                if (peek().type != TokenType::END_OF_FILE &&
+                    peek().type == type) {
+                    ++current;
+                    return true;
+                }
+            }
+            return false;
+        }
+        constexpr const EmbeddedToken& peek() const {
+            return tokens[current];
+        }
+        constexpr const EmbeddedToken& previous() const {
+            return tokens[current - 1];
+        }
+
+        EmbeddedExpr<N> result;
+        /// @brief every character makes at most one token, plus END_OF_FILE
+        EmbeddedToken tokens[N];
+        size_t tokenCount;
+        size_t current;
+    };
+
+    /// @brief parses a string literal at compile time when used to
+    /// initialize a constexpr variable:
+    ///     constexpr auto expr = lox::embed("(a + 1) * 2");
+    /// Syntax errors in the literal are compile errors.
+    template <size_t N>
+    constexpr EmbeddedExpr<N> embed(const char (&source)[N]) {
+        EmbeddedParser<N> parser(source);
+        return parser.parse();
+    }
+} // namespace lox
+
+#endif // EMBEDDED_EXPR_HPP
@@ -1,5 +1,9 @@
 #include "parser.hpp"
 #include "../error_handler/error_handler.hpp"
+#include "../governor/budget.hpp"
+#include "../tools/ast_deleter.hpp"
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 using namespace lox;
@@ -8,90 +12,273 @@ ParseError::ParseError(std::string msg, Token token)
     : std::runtime_error(msg)
     , token_(token) {}
 
-Parser::Parser(const std::vector<Token>& tokens, ErrorHandler& errorHandler)
+namespace {
+    struct SubtreeDeleter {
+        void operator()(Expr* expr) const {
+            ASTDeleter deleter;
+            deleter.destroy(expr);
+        }
+    };
+    /// @brief owns a subtree until it is handed to its parent, so that
+    /// whatever was built is freed when a parse error or an exceeded limit
+    /// unwinds the parser
+    using Subtree = std::unique_ptr<Expr, SubtreeDeleter>;
+
+    /// @brief binding power of each binary operator, matching the order of
+    /// equality(), comparison(), term() and factor(). 0 if not binary.
+    int binaryPrecedence(TokenType type) {
+        switch (type) {
+            case TokenType::BANG_EQUAL:
+            case TokenType::EQUAL_EQUAL:
+                return 1;
+            case TokenType::GREATER:
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+                return 2;
+            case TokenType::MINUS:
+            case TokenType::PLUS:
+                return 3;
+            case TokenType::SLASH:
+            case TokenType::STAR:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    /// @brief prefix operators bind tighter than any binary operator
+    const int unaryPrecedence = 5;
+    /// @brief an open '(' is never reduced by an operator
+    const int groupPrecedence = 0;
+
+    struct PendingOperator {
+        Token token;
+        int precedence;
+    };
+
+    /// @brief pops operators with at least minPrecedence, combining them
+    /// with their operands. Returns the number of nodes created, depth is
+    /// decreased by the prefix operators among them.
+    size_t reduce(std::vector<PendingOperator>& operators,
+                  std::vector<Subtree>& operands, int minPrecedence,
+                  size_t& depth) {
+        size_t created = 0;
+        while (!operators.empty() &&
+               operators.back().precedence != groupPrecedence &&
+               operators.back().precedence >= minPrecedence) {
+            const PendingOperator pending = operators.back();
+            operators.pop_back();
+            Expr* right = operands.back().release();
+            operands.pop_back();
+            if (pending.precedence == unaryPrecedence) {
+                operands.emplace_back(new UnaryExpr(pending.token, right));
+                --depth;
+            } else {
+                Expr* left = operands.back().release();
+                operands.back().reset(
+                    new BinaryExpr(left, pending.token, right));
+            }
+            ++created;
+        }
+        return created;
+    }
+} // namespace
+
+Parser::Parser(const std::vector<Token>& tokens, ErrorHandler& errorHandler,
+               Mode mode, const Budget* budget)
     : current(0)
     , tokens_(tokens)
-    , errorHandler_(errorHandler) {}
+    , errorHandler_(errorHandler)
+    , mode_(mode)
+    , budget_(budget)
+    , nodes_(0)
+    , nextCheck_(0)
+    , depth_(0) {}
 
 Expr* Parser::expression() {
     return equality();
 }
 
 Expr* Parser::equality() {
-    Expr* expr = comparison();
+    Subtree expr(comparison());
     while (match({TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL})) {
         Token Operator = previous();
-        Expr* right    = comparison();
-        expr           = new BinaryExpr(expr, Operator, right);
+        Subtree right(comparison());
+        spendNodes(1);
+        expr.reset(new BinaryExpr(expr.release(), Operator, right.release()));
     }
-    return expr;
+    return expr.release();
 }
 
 Expr* Parser::comparison() {
-    Expr* expr = term();
+    Subtree expr(term());
     while (
         match({TokenType::GREATER, TokenType::LESS, TokenType::LESS_EQUAL})) {
         Token Operator = previous();
-        Expr* right    = term();
-        expr           = new BinaryExpr(expr, Operator, right);
+        Subtree right(term());
+        spendNodes(1);
+        expr.reset(new BinaryExpr(expr.release(), Operator, right.release()));
     }
-    return expr;
+    return expr.release();
 }
 
 Expr* Parser::term() {
-    Expr* expr = factor();
+    Subtree expr(factor());
     while (match({TokenType::MINUS, TokenType::PLUS})) {
         Token Operator = previous();
-        Expr* right    = factor();
-        expr           = new BinaryExpr(expr, Operator, right);
+        Subtree right(factor());
+        spendNodes(1);
+        expr.reset(new BinaryExpr(expr.release(), Operator, right.release()));
     }
-    return expr;
+    return expr.release();
 }
 
 Expr* Parser::factor() {
-    Expr* expr = unary();
+    Subtree expr(unary());
     while (match({TokenType::SLASH, TokenType::STAR})) {
         Token Operator = previous();
-        Expr* right    = unary();
-        expr           = new BinaryExpr(expr, Operator, right);
+        Subtree right(unary());
+        spendNodes(1);
+        expr.reset(new BinaryExpr(expr.release(), Operator, right.release()));
     }
-    return expr;
+    return expr.release();
 }
 
 Expr* Parser::unary() {
     if (match({TokenType::BANG, TokenType::MINUS})) {
         Token Operator = previous();
-        Expr* right    = unary();
-        return new UnaryExpr(Operator, right);
+        enterNesting();
+        Subtree right(unary());
+        --depth_;
+        spendNodes(1);
+        return new UnaryExpr(Operator, right.release());
     }
     return primary();
 }
 
 Expr* Parser::primary() {
-    if (match({TokenType::FALSE}))
-        return new LiteralExpr("false");
-    if (match({TokenType::TRUE}))
-        return new LiteralExpr("true");
-    if (match({TokenType::NIL}))
-        return new LiteralExpr("nil");
-    if (match({TokenType::NUMBER, TokenType::STRING}))
-        return new LiteralExpr(previous().literal);
+    Subtree expr(leaf());
+    if (expr != nullptr) {
+        spendNodes(1);
+        return expr.release();
+    }
     if (match({TokenType::LEFT_PAREN})) {
-        Expr* expr = expression();
+        const uint32_t paren = previous().offset;
+        enterNesting();
+        Subtree inner(expression());
         consume(TokenType::RIGHT_PAREN, "Exppect ')' after expression.");
-        return new GroupingExpr(expr);
+        --depth_;
+        spendNodes(1);
+        Expr* group = new GroupingExpr(inner.release());
+        group->locate(paren);
+        return group;
     }
     throw error(peek(), "Expect expression.");
     return nullptr;
 }
 
+Expr* Parser::leaf() {
+    if (match({TokenType::IDENTIFIER}))
+        return new VariableExpr(previous());
+    Expr* expr = nullptr;
+    if (match({TokenType::FALSE})) {
+        expr = new LiteralExpr(Literal::boolean(false));
+    } else if (match({TokenType::TRUE})) {
+        expr = new LiteralExpr(Literal::boolean(true));
+    } else if (match({TokenType::NIL})) {
+        expr = new LiteralExpr(Literal());
+    } else if (match({TokenType::NUMBER, TokenType::STRING})) {
+        expr = new LiteralExpr(previous().literal);
+    } else {
+        return nullptr;
+    }
+    // a literal keeps no token to tell where it came from
+    expr->locate(previous().offset);
+    return expr;
+}
+
+Expr* Parser::iterativeExpression() {
+    std::vector<PendingOperator> operators;
+    std::vector<Subtree> operands;
+    size_t openGroups = 0;
+    while (true) {
+        // prefix operators and opening parentheses before an operand
+        while (match({TokenType::BANG, TokenType::MINUS,
+                      TokenType::LEFT_PAREN})) {
+            if (previous().type == TokenType::LEFT_PAREN) {
+                operators.push_back({previous(), groupPrecedence});
+                ++openGroups;
+            } else {
+                operators.push_back({previous(), unaryPrecedence});
+            }
+            enterNesting();
+        }
+        Subtree operand(leaf());
+        if (operand == nullptr)
+            throw error(peek(), "Expect expression.");
+        operands.push_back(std::move(operand));
+        spendNodes(1);
+        // closing parentheses and the binary operator after an operand
+        while (openGroups > 0 && match({TokenType::RIGHT_PAREN})) {
+            spendNodes(reduce(operators, operands, 1, depth_) + 1);
+            const uint32_t paren = operators.back().token.offset;
+            operators.pop_back();
+            operands.back().reset(new GroupingExpr(operands.back().release()));
+            operands.back()->locate(paren);
+            --openGroups;
+            --depth_;
+        }
+        const int precedence = isAtEnd() ? 0 : binaryPrecedence(peek().type);
+        if (precedence == 0)
+            break;
+        spendNodes(reduce(operators, operands, precedence, depth_));
+        operators.push_back({advance(), precedence});
+    }
+    if (openGroups > 0)
+        consume(TokenType::RIGHT_PAREN, "Exppect ')' after expression.");
+    spendNodes(reduce(operators, operands, 1, depth_));
+    return operands.back().release();
+}
+
 Expr* Parser::parse() {
     try {
+        if (mode_ == Mode::ITERATIVE)
+            return iterativeExpression();
         return expression();
     } catch (ParseError error) {
         return nullptr;
     }
 }
+void Parser::spendNodes(size_t count) {
+    if (budget_ == nullptr)
+        return;
+    nodes_ += count;
+    if (nodes_ < nextCheck_)
+        return;
+    if (nodes_ > budget_->maxNodes) {
+        throw limitExceeded("more than " + std::to_string(budget_->maxNodes) +
+                            " nodes");
+    }
+    const char* reason = budget_->interrupted();
+    if (reason != nullptr)
+        throw limitExceeded(reason);
+    // look at the clock again later, or right when going over the limit
+    const size_t left = budget_->maxNodes - nodes_;
+    nextCheck_        = nodes_ + std::min(left, Budget::checkInterval - 1) + 1;
+}
+
+void Parser::enterNesting() {
+    ++depth_;
+    if (budget_ != nullptr && depth_ > budget_->maxDepth) {
+        throw limitExceeded("nesting deeper than " +
+                            std::to_string(budget_->maxDepth));
+    }
+}
+
+ParseError Parser::limitExceeded(const std::string& what) {
+    return error(peek(), "Resource limit exceeded: " + what + ".");
+}
+
 Token Parser::consume(TokenType type, std::string message) {
     if (check(type))
         return advance();
@@ -100,12 +287,12 @@ Token Parser::consume(TokenType type, std::string message) {
 
 ParseError Parser::error(Token token, std::string message) {
     if (token.type == TokenType::END_OF_FILE) {
-        errorHandler_.add(token.line, " at end", message);
+        errorHandler_.add(token.offset, " at end", message);
     } else {
-        errorHandler_.add(token.line, "at '" + token.lexeme + "'", message);
+        errorHandler_.add(token.offset, "at '" + token.lexeme + "'", message);
     }
     errorHandler_.report();
-    return *new ParseError(message, token);
+    return ParseError(message, token);
 }
 
 bool Parser::match(const std::vector<TokenType>& types) {
@@ -10,6 +10,7 @@
 namespace lox {
     // forward declarations
     class ErrorHandler;
+    struct Budget;
 
     class ParseError : public std::runtime_error {
       public:
@@ -19,7 +20,14 @@ namespace lox {
 
     class Parser {
       public:
-        Parser(const std::vector<Token>& tokens, ErrorHandler& errorHandler);
+        /// @brief RECURSIVE is plain recursive descent. ITERATIVE keeps
+        /// pending operators and operands on heap-allocated stacks, so
+        /// nesting depth is only bounded by memory, not by the call stack.
+        enum class Mode { RECURSIVE, ITERATIVE };
+        /// @brief with a budget, parsing stops at the first exceeded limit,
+        /// the budget must outlive the parser
+        Parser(const std::vector<Token>& tokens, ErrorHandler& errorHandler,
+               Mode mode = Mode::RECURSIVE, const Budget* budget = nullptr);
         size_t current;
         Expr* expression();
         Expr* equality();
@@ -28,10 +36,16 @@ namespace lox {
         Expr* factor();
         Expr* unary();
         Expr* primary();
+        /// @brief operator precedence parser producing the same tree as
+        /// expression() without recursion
+        Expr* iterativeExpression();
         Expr* parse();
         ParseError error(Token token, std::string message);
 
       private:
+        /// @brief parses a literal or variable, returns nullptr if the
+        /// current token doesn't start one
+        Expr* leaf();
         bool match(const std::vector<TokenType>& types);
         Token previous();
         Token advance();
@@ -39,8 +53,21 @@ namespace lox {
         bool isAtEnd();
         bool check(TokenType type);
         Token consume(TokenType type, std::string message);
+        /// @brief accounts for count new nodes, throws once the budget is
+        /// exceeded
+        void spendNodes(size_t count);
+        /// @brief called when going one level of nesting deeper
+        void enterNesting();
+        ParseError limitExceeded(const std::string& what);
         ErrorHandler& errorHandler_;
         std::vector<Token> tokens_;
+        Mode mode_;
+        const Budget* budget_;
+        size_t nodes_;
+        /// @brief node count at which the budget is checked next
+        size_t nextCheck_;
+        /// @brief current nesting of parentheses and prefix operators
+        size_t depth_;
     };
 } // namespace lox
 
@@ -0,0 +1,151 @@
+#include "pipeline.hpp"
+#include "../error_handler/error_handler.hpp"
+#include "../parser/parser.hpp"
+#include "../scanner/scanner.hpp"
+#include "../tools/ast_deleter.hpp"
+#include "../tools/ast_printer.hpp"
+#include "spsc_queue.hpp"
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace lox;
+
+namespace {
+    /// @brief groups the tokens of a batch into ';' separated statements and
+    /// calls emit with every statement that parsed. statement carries the
+    /// tokens of an unfinished statement over to the next batch. Returns
+    /// true once the end of the source was reached.
+    /// The parser reports its whole error list on every error, so each
+    /// statement is parsed against the emptied statementErrors, which should
+    /// write nowhere, and its errors are moved to parseErrors.
+    template <typename Emit>
+    bool parseStatements(const std::vector<Token>& batch,
+                         std::vector<Token>& statement,
+                         ErrorHandler& statementErrors,
+                         ErrorHandler& parseErrors, Emit emit) {
+        for (const auto& token : batch) {
+            const bool atEnd = token.type == TokenType::END_OF_FILE;
+            if (token.type != TokenType::SEMICOLON && !atEnd) {
+                statement.push_back(token);
+                continue;
+            }
+            if (!statement.empty()) {
+                statement.push_back(
+                    Token(TokenType::END_OF_FILE, "", Literal(), token.offset));
+                Parser parser(statement, statementErrors,
+                              Parser::Mode::ITERATIVE);
+                Expr* expr = parser.parse();
+                if (expr != nullptr)
+                    emit(expr);
+                if (statementErrors.foundError) {
+                    parseErrors.append(statementErrors);
+                    statementErrors.clear();
+                    statementErrors.foundError = false;
+                }
+                statement.clear();
+            }
+            if (atEnd)
+                return true;
+        }
+        return false;
+    }
+
+    void printAndDelete(Expr* expr, std::ostream& out) {
+        ASTPrinter printer(ASTPrinter::Mode::ITERATIVE, out);
+        printer.print(expr);
+        out << '\n';
+        ASTDeleter deleter;
+        deleter.destroy(expr);
+    }
+
+    /// @brief reports the errors a stage collected and adds them to into
+    void reportStageErrors(const ErrorHandler& stageErrors,
+                           ErrorHandler& into) {
+        if (!stageErrors.foundError)
+            return;
+        stageErrors.report();
+        into.append(stageErrors);
+    }
+} // namespace
+
+Pipeline::Pipeline(const std::string& source, ErrorHandler& errorHandler,
+                   std::ostream& out, size_t batchSize, size_t queueCapacity)
+    : source_(source)
+    , errorHandler_(errorHandler)
+    , out_(out)
+    , batchSize_(batchSize)
+    , queueCapacity_(queueCapacity) {
+    // an empty batch would never reach the end of the source
+    if (batchSize_ == 0)
+        throw std::invalid_argument("Pipeline batch size must be positive.");
+}
+
+void Pipeline::run() {
+    SpscQueue<std::vector<Token>> tokenQueue(queueCapacity_);
+    // a nullptr marks the end of the expressions
+    SpscQueue<Expr*> exprQueue(queueCapacity_);
+    // each stage gets its own error handlers, ErrorHandler isn't thread
+    // safe. The stages only collect errors, this thread reports them.
+    ErrorHandler scanErrors;
+    scanErrors.setSource(source_);
+    std::ostream discard(nullptr);
+    ErrorHandler statementErrors(discard);
+    statementErrors.setSource(source_);
+    ErrorHandler parseErrors;
+    errorHandler_.setSource(source_);
+
+    std::thread scanStage([&]() {
+        Scanner scanner(source_, scanErrors);
+        bool atEnd = false;
+        while (!atEnd) {
+            std::vector<Token> batch = scanner.scanBatch(batchSize_);
+            // the batch that reaches the end of the source is the last one
+            atEnd = batch.back().type == TokenType::END_OF_FILE;
+            tokenQueue.push(std::move(batch));
+        }
+    });
+    std::thread parseStage([&]() {
+        std::vector<Token> statement;
+        bool atEnd = false;
+        while (!atEnd) {
+            atEnd = parseStatements(tokenQueue.pop(), statement,
+                                    statementErrors, parseErrors,
+                                    [&](Expr* expr) { exprQueue.push(expr); });
+        }
+        exprQueue.push(nullptr);
+    });
+
+    // print stage
+    for (Expr* expr = exprQueue.pop(); expr != nullptr; expr = exprQueue.pop())
+        printAndDelete(expr, out_);
+    out_.flush();
+
+    scanStage.join();
+    parseStage.join();
+    reportStageErrors(scanErrors, errorHandler_);
+    reportStageErrors(parseErrors, errorHandler_);
+}
+
+void Pipeline::runSequential() {
+    ErrorHandler scanErrors;
+    scanErrors.setSource(source_);
+    std::ostream discard(nullptr);
+    ErrorHandler statementErrors(discard);
+    statementErrors.setSource(source_);
+    ErrorHandler parseErrors;
+    errorHandler_.setSource(source_);
+
+    Scanner scanner(source_, scanErrors);
+    const std::vector<Token> tokens = scanner.scanAndGetTokens();
+    std::vector<Expr*> exprs;
+    std::vector<Token> statement;
+    parseStatements(tokens, statement, statementErrors, parseErrors,
+                    [&](Expr* expr) { exprs.push_back(expr); });
+    for (Expr* expr : exprs)
+        printAndDelete(expr, out_);
+    out_.flush();
+
+    reportStageErrors(scanErrors, errorHandler_);
+    reportStageErrors(parseErrors, errorHandler_);
+}
@@ -0,0 +1,46 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace lox {
+    // forward declarations
+    class ErrorHandler;
+
+    /// @brief scans, parses and prints a source made of ';' separated
+    /// expressions. run() puts the scanner and the parser on their own
+    /// threads, connected to each other and to the printing stage on the
+    /// calling thread through bounded SPSC queues. runSequential() does the
+    /// same work one stage after another on the calling thread.
+    ///
+    /// The stages overlap between statements only: a statement is parsed
+    /// once its ';' was scanned and printed once it was parsed. A source
+    /// without ';' is a single statement whose tokens are all held until
+    /// the end of the source, so it gets no overlap and memory grows with
+    /// its size.
+    class Pipeline {
+      public:
+        /// @brief throws std::invalid_argument if batchSize is 0
+        Pipeline(const std::string& source, ErrorHandler& errorHandler,
+                 std::ostream& out, size_t batchSize = 512,
+                 size_t queueCapacity = 16);
+        void run();
+        void runSequential();
+
+      private:
+        /// @brief string containing the entire lox source code
+        const std::string& source_;
+        /// @brief gets the scan and parse errors once all stages are done
+        ErrorHandler& errorHandler_;
+        /// @brief where the printed expressions go
+        std::ostream& out_;
+        /// @brief maximum number of tokens handed over at once
+        const size_t batchSize_;
+        /// @brief maximum number of batches (and expressions) in flight
+        const size_t queueCapacity_;
+    };
+} // namespace lox
+
+#endif // PIPELINE_HPP
@@ -0,0 +1,108 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace lox {
+    /// @brief bounded lock-free queue for exactly one producer thread and one
+    /// consumer thread. push blocks while the queue is full, which is what
+    /// keeps a fast producer from running arbitrarily far ahead. A side that
+    /// has to wait spins briefly and then sleeps until the other side wakes
+    /// it, so an idle stage doesn't keep a core busy.
+    template <typename T>
+    class SpscQueue {
+      public:
+        /// @brief capacity is rounded up to a power of two
+        explicit SpscQueue(size_t capacity)
+            : head_(0)
+            , tail_(0)
+            , producerWaiting_(false)
+            , consumerWaiting_(false) {
+            size_t size = 2;
+            while (size < capacity)
+                size *= 2;
+            slots_.resize(size);
+            mask_ = size - 1;
+        }
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        /// @brief called by the producer only
+        void push(T value) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            waitUntil(producerWaiting_, notFull_, [&]() {
+                return tail - head_.load(std::memory_order_acquire) !=
+                       slots_.size();
+            });
+            slots_[tail & mask_] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            wake(consumerWaiting_, notEmpty_);
+        }
+
+        /// @brief called by the consumer only
+        T pop() {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            waitUntil(consumerWaiting_, notEmpty_, [&]() {
+                return tail_.load(std::memory_order_acquire) != head;
+            });
+            T value = std::move(slots_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            wake(producerWaiting_, notFull_);
+            return value;
+        }
+
+      private:
+        /// @brief yields this many times before going to sleep
+        static constexpr int spinLimit = 64;
+
+        template <typename Ready>
+        void waitUntil(std::atomic<bool>& waiting,
+                       std::condition_variable& wakeUp, Ready ready) {
+            for (int spin = 0; spin < spinLimit; ++spin) {
+                if (ready())
+                    return;
+                std::this_thread::yield();
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            waiting.store(true, std::memory_order_relaxed);
+            // pairs with the fence in wake: either the other side sees
+            // waiting set or ready() sees what it just published
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!ready())
+                wakeUp.wait(lock);
+            waiting.store(false, std::memory_order_relaxed);
+        }
+
+        void wake(std::atomic<bool>& waiting,
+                  std::condition_variable& wakeUp) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!waiting.load(std::memory_order_relaxed))
+                return;
+            // the waiter holds the mutex from its last look at the queue
+            // until it sleeps, so the notify can't fall in between
+            std::lock_guard<std::mutex> lock(mutex_);
+            wakeUp.notify_one();
+        }
+
+        /// @brief head and tail are written by different threads, keep them
+        /// on separate cache lines
+        alignas(64) std::atomic<size_t> head_;
+        alignas(64) std::atomic<size_t> tail_;
+        alignas(64) std::vector<T> slots_;
+        size_t mask_;
+        /// @brief only used once a side has to sleep
+        std::mutex mutex_;
+        std::condition_variable notFull_;
+        std::condition_variable notEmpty_;
+        std::atomic<bool> producerWaiting_;
+        std::atomic<bool> consumerWaiting_;
+    };
+} // namespace lox
+
+#endif // SPSC_QUEUE_HPP
@@ -0,0 +1,207 @@
+#include "profiler.hpp"
+#include "../scanner/source_map.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace lox;
+using namespace lox::profiler;
+
+thread_local ScopedVisit* lox::profiler::currentVisit = nullptr;
+
+namespace {
+    struct Counter {
+        const char* name     = nullptr;
+        uint64_t visits      = 0;
+        uint64_t totalCycles = 0;
+        uint64_t selfCycles  = 0;
+        void add(const Counter& other) {
+            name = other.name;
+            visits += other.visits;
+            totalCycles += other.totalCycles;
+            selfCycles += other.selfCycles;
+        }
+    };
+
+    /// @brief counters of one thread, or of every thread that has exited
+    struct Counters {
+        Counter kinds[maxNodeKinds];
+        /// @brief indexed by node slot
+        std::vector<Counter> slots;
+        void add(const Counters& other) {
+            for (size_t kind = 0; kind < maxNodeKinds; ++kind)
+                if (other.kinds[kind].visits != 0)
+                    kinds[kind].add(other.kinds[kind]);
+            if (slots.size() < other.slots.size())
+                slots.resize(other.slots.size());
+            for (size_t slot = 0; slot < other.slots.size(); ++slot)
+                if (other.slots[slot].visits != 0)
+                    slots[slot].add(other.slots[slot]);
+        }
+        void clear() {
+            for (auto& kind : kinds)
+                kind = Counter();
+            slots.clear();
+        }
+    };
+
+    /// @brief every live thread's counters. Threads only lock it when they
+    /// first record and when they exit, so recording itself is lock free;
+    /// report and reset must not run while instrumented code does.
+    struct Registry {
+        std::mutex mutex;
+        std::vector<Counters*> live;
+        Counters retired;
+        std::atomic<size_t> nextSlot{0};
+        /// @brief source offset of every located slot
+        std::vector<size_t> offsets;
+    };
+
+    Registry& registry() {
+        // leaked so that threads exiting after main still find it
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+
+    /// @brief registers on construction and folds into retired on exit
+    struct ThreadCounters {
+        ThreadCounters() {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            registry().live.push_back(&counters);
+        }
+        ~ThreadCounters() {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            auto& live = registry().live;
+            live.erase(std::find(live.begin(), live.end(), &counters));
+            registry().retired.add(counters);
+        }
+        Counters counters;
+    };
+
+    Counters& threadCounters() {
+        thread_local ThreadCounters instance;
+        return instance.counters;
+    }
+
+    /// @brief right aligned column of the report tables
+    std::ostream& cell(std::ostream& out, size_t width) {
+        return out << std::setw(static_cast<int>(width));
+    }
+} // namespace
+
+size_t lox::profiler::newSlot() {
+    return registry().nextSlot.fetch_add(1, std::memory_order_relaxed);
+}
+
+void lox::profiler::locate(size_t slot, size_t offset) {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    auto& offsets = registry().offsets;
+    if (offsets.size() <= slot)
+        offsets.resize(std::max(slot + 1, offsets.size() * 2), noLocation);
+    offsets[slot] = offset;
+}
+
+void lox::profiler::record(size_t kind, const char* kindName, size_t slot,
+                           uint64_t totalCycles, uint64_t selfCycles) {
+    Counters& counters = threadCounters();
+    Counter& counter   = counters.kinds[kind % maxNodeKinds];
+    counter.name       = kindName;
+    counter.visits++;
+    counter.totalCycles += totalCycles;
+    counter.selfCycles += selfCycles;
+    auto& slots = counters.slots;
+    if (slots.size() <= slot)
+        slots.resize(std::max(slot + 1, slots.size() * 2));
+    Counter& node = slots[slot];
+    node.name     = kindName;
+    node.visits++;
+    node.totalCycles += totalCycles;
+    node.selfCycles += selfCycles;
+}
+
+void lox::profiler::report(std::ostream& out, const std::string& source,
+                           size_t top) {
+    Counters merged;
+    std::vector<size_t> offsets;
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        merged.add(registry().retired);
+        for (auto counters : registry().live)
+            merged.add(*counters);
+        offsets = registry().offsets;
+    }
+
+    out << "-- visits by node kind --" << std::endl;
+    out << std::left << std::setw(14) << "kind" << std::right;
+    cell(out, 12) << "visits";
+    cell(out, 16) << "self cycles";
+    cell(out, 16) << "total cycles";
+    cell(out, 12) << "self/visit" << std::endl;
+    for (const auto& kind : merged.kinds) {
+        if (kind.visits == 0)
+            continue;
+        out << std::left << std::setw(14) << kind.name << std::right;
+        cell(out, 12) << kind.visits;
+        cell(out, 16) << kind.selfCycles;
+        cell(out, 16) << kind.totalCycles;
+        cell(out, 12) << kind.selfCycles / kind.visits << std::endl;
+    }
+
+    // the nodes of a line add up, totals would count nested nodes twice
+    struct Line {
+        size_t number;
+        uint64_t visits;
+        uint64_t selfCycles;
+        /// @brief node with the most self cycles on the line
+        const Counter* hottest;
+        size_t hottestColumn;
+    };
+    SourceMap sourceMap(source);
+    std::unordered_map<size_t, Line> lines;
+    for (size_t slot = 0; slot < merged.slots.size(); ++slot) {
+        const Counter& counter = merged.slots[slot];
+        if (counter.visits == 0 || slot >= offsets.size() ||
+            offsets[slot] > source.size())
+            continue;
+        const auto location = sourceMap.locate(offsets[slot]);
+        auto inserted       = lines.insert(
+            {location.line, {location.line, 0, 0, &counter, location.column}});
+        Line& line = inserted.first->second;
+        line.visits += counter.visits;
+        line.selfCycles += counter.selfCycles;
+        if (counter.selfCycles > line.hottest->selfCycles) {
+            line.hottest       = &counter;
+            line.hottestColumn = location.column;
+        }
+    }
+    std::vector<Line> hottest;
+    for (const auto& line : lines)
+        hottest.push_back(line.second);
+    const size_t shown = std::min(top, hottest.size());
+    std::partial_sort(hottest.begin(), hottest.begin() + shown, hottest.end(),
+                      [](const Line& a, const Line& b) {
+                          return a.selfCycles > b.selfCycles;
+                      });
+    if (shown == 0)
+        return;
+    out << "-- hottest lines by self cycles --" << std::endl;
+    for (size_t i = 0; i < shown; ++i) {
+        const Line& line = hottest[i];
+        out << "[line " << line.number << "] " << line.visits << " visits, "
+            << line.selfCycles << " self cycles, most in "
+            << line.hottest->name << " at column " << line.hottestColumn
+            << std::endl;
+        out << SourceMap::snippet(sourceMap.lineText(line.number),
+                                  line.hottestColumn);
+    }
+}
+
+void lox::profiler::reset() {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().retired.clear();
+    for (auto counters : registry().live)
+        counters->clear();
+}
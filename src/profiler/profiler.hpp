@@ -0,0 +1,96 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace lox {
+    namespace profiler {
+        // Visit counters for instrumented builds. The AST generator, when run
+        // with --instrument, puts a ScopedVisit in every accept(); otherwise
+        // nothing here is ever called.
+
+        /// @brief location of nodes nobody located
+        const size_t noLocation = static_cast<size_t>(-1);
+        /// @brief upper bound on the number of generated node classes
+        const size_t maxNodeKinds = 16;
+
+        /// @brief numbers a new node, its counters live at that index so
+        /// that recording a visit needs no lookup
+        size_t newSlot();
+        /// @brief sets the source offset the counters of slot are reported
+        /// under
+        void locate(size_t slot, size_t offset);
+
+        /// @brief cycle counter, or nanoseconds where there is none
+        inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+#endif
+        }
+
+        /// @brief adds one visit to the calling thread's counters
+        void record(size_t kind, const char* kindName, size_t slot,
+                    uint64_t totalCycles, uint64_t selfCycles);
+
+        class ScopedVisit;
+        /// @brief innermost visit in progress on this thread
+        extern thread_local ScopedVisit* currentVisit;
+
+        /// @brief times a visit from construction to destruction. Time spent
+        /// in nested visits is subtracted to get the node's self time.
+        class ScopedVisit {
+          public:
+            ScopedVisit(size_t kind, const char* kindName, size_t slot)
+                : kind_(kind)
+                , kindName_(kindName)
+                , slot_(slot)
+                , childCycles_(0)
+                , parent_(currentVisit)
+                , start_(now()) {
+                currentVisit = this;
+            }
+            ~ScopedVisit() {
+                const uint64_t total = now() - start_;
+                currentVisit         = parent_;
+                if (parent_ != nullptr)
+                    parent_->childCycles_ += total;
+                const uint64_t self =
+                    total > childCycles_ ? total - childCycles_ : 0;
+                record(kind_, kindName_, slot_, total, self);
+            }
+            ScopedVisit(const ScopedVisit&) = delete;
+            ScopedVisit& operator=(const ScopedVisit&) = delete;
+
+          private:
+            const size_t kind_;
+            const char* kindName_;
+            const size_t slot_;
+            uint64_t childCycles_;
+            ScopedVisit* parent_;
+            const uint64_t start_;
+        };
+
+        /// @brief prints visits and cycles per node kind, and the source
+        /// lines whose nodes took the most self cycles. source is what the
+        /// located offsets refer to.
+        void report(std::ostream& out, const std::string& source,
+                    size_t top = 10);
+        /// @brief drops the counters of every thread
+        void reset();
+    } // namespace profiler
+} // namespace lox
+
+#endif // PROFILER_HPP
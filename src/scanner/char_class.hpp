@@ -0,0 +1,52 @@
+#ifndef CHAR_CLASS_HPP
+#define CHAR_CLASS_HPP
+
+#include "token.hpp"
+#include <cstddef>
+#include <string_view>
+
+namespace lox {
+    // Character and keyword classification shared by the runtime Scanner and
+    // the compile-time scanner in parser/embedded_expr.hpp, constexpr so both
+    // can use it.
+
+    constexpr bool isDigit(const char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    constexpr bool isAlpha(const char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    constexpr bool isAlphaNumeric(const char c) {
+        return isAlpha(c) || isDigit(c);
+    }
+
+    struct ReservedKeyword {
+        std::string_view text;
+        TokenType type;
+    };
+
+    /// @brief reserved keywords e.g. and, or, for, else, nil etc.
+    constexpr ReservedKeyword reservedKeywords[] = {
+        {"and", TokenType::AND},       {"class", TokenType::CLASS},
+        {"else", TokenType::ELSE},     {"false", TokenType::FALSE},
+        {"for", TokenType::FOR},       {"fun", TokenType::FUN},
+        {"if", TokenType::IF},         {"nil", TokenType::NIL},
+        {"or", TokenType::OR},         {"print", TokenType::PRINT},
+        {"return", TokenType::RETURN}, {"super", TokenType::SUPER},
+        {"this", TokenType::THIS},     {"true", TokenType::TRUE},
+        {"var", TokenType::VAR},       {"while", TokenType::WHILE}};
+
+    /// @brief token type of an identifier, which is IDENTIFIER unless it is
+    /// a reserved keyword
+    constexpr TokenType keywordType(const std::string_view identifier) {
+        for (const auto& keyword : reservedKeywords) {
+            if (keyword.text == identifier)
+                return keyword.type;
+        }
+        return TokenType::IDENTIFIER;
+    }
+} // namespace lox
+
+#endif // CHAR_CLASS_HPP
@@ -0,0 +1,141 @@
+#include "literal.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <utility>
+
+using namespace lox;
+
+Literal::Literal()
+    : type(Type::NIL)
+    , boolValue(false)
+    , numberValue(0) {}
+
+Literal Literal::boolean(bool value) {
+    Literal literal;
+    literal.type      = Type::BOOL;
+    literal.boolValue = value;
+    return literal;
+}
+
+Literal Literal::number(double value) {
+    Literal literal;
+    literal.type        = Type::NUMBER;
+    literal.numberValue = value;
+    return literal;
+}
+
+Literal Literal::string(std::string value) {
+    Literal literal;
+    literal.type        = Type::STRING;
+    literal.stringValue = std::move(value);
+    return literal;
+}
+
+Literal Literal::parseNumber(std::string_view digits) {
+    // the scanner only accepts digits with an optional fraction, which
+    // from_chars always decodes; out of range values saturate to infinity
+    double value = 0;
+    const auto result =
+        std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (result.ec == std::errc::result_out_of_range)
+        value = HUGE_VAL;
+    return number(value);
+}
+
+size_t Literal::formatNumber(double value, char* buffer) {
+    // to_chars without a precision picks the shortest digits that read back
+    // as value. Those digits are then laid out like JavaScript does: fixed
+    // for decimal exponents in [-6, 20], scientific beyond.
+    const auto format     = std::chars_format::scientific;
+    char* const end       = buffer + maxNumberLength;
+    const auto scientific = std::to_chars(buffer, end, value, format);
+    if (!std::isfinite(value))
+        return scientific.ptr - buffer;
+    // buffer holds [-]d[.ddd]e(+|-)xx
+    char* const mark          = std::find(buffer, scientific.ptr, 'e');
+    const char* exponentBegin = mark + 1;
+    if (*exponentBegin == '+')
+        ++exponentBegin;
+    int exponent = 0;
+    std::from_chars(exponentBegin, scientific.ptr, exponent);
+    if (exponent < -6 || exponent > 20) {
+        // to_chars pads the exponent to two digits, JavaScript doesn't:
+        // 1e-8 and 1e+23
+        char* const exponentDigits = mark + 2;
+        char* const significant =
+            std::find_if(exponentDigits, scientific.ptr - 1,
+                         [](char c) { return c != '0'; });
+        return std::copy(significant, scientific.ptr, exponentDigits) - buffer;
+    }
+
+    const bool negative = buffer[0] == '-';
+    char digits[maxNumberLength];
+    size_t digitCount = 0;
+    for (const char* c = buffer + negative; c != mark; ++c)
+        if (*c != '.')
+            digits[digitCount++] = *c;
+    // the sign stays, everything after it is rewritten
+    char* out = buffer + negative;
+    if (exponent < 0) {
+        *out++ = '0';
+        *out++ = '.';
+        out    = std::fill_n(out, -exponent - 1, '0');
+        out    = std::copy(digits, digits + digitCount, out);
+    } else {
+        const size_t integerDigits = exponent + 1;
+        if (digitCount <= integerDigits) {
+            out = std::copy(digits, digits + digitCount, out);
+            out = std::fill_n(out, integerDigits - digitCount, '0');
+        } else {
+            out    = std::copy(digits, digits + integerDigits, out);
+            *out++ = '.';
+            out    = std::copy(digits + integerDigits, digits + digitCount,
+                               out);
+        }
+    }
+    return out - buffer;
+}
+
+std::string Literal::toString() const {
+    switch (type) {
+        case Type::NIL:
+            return "nil";
+        case Type::BOOL:
+            return boolValue ? "true" : "false";
+        case Type::NUMBER: {
+            char buffer[maxNumberLength];
+            return std::string(buffer, formatNumber(numberValue, buffer));
+        }
+        case Type::STRING:
+            return stringValue;
+    }
+    return "";
+}
+
+bool Literal::operator==(const Literal& other) const {
+    if (type != other.type)
+        return false;
+    switch (type) {
+        case Type::NIL:
+            return true;
+        case Type::BOOL:
+            return boolValue == other.boolValue;
+        case Type::NUMBER:
+            return numberValue == other.numberValue;
+        case Type::STRING:
+            return stringValue == other.stringValue;
+    }
+    return false;
+}
+
+std::ostream& lox::operator<<(std::ostream& out, const Literal& literal) {
+    if (literal.type == Literal::Type::NUMBER) {
+        char buffer[Literal::maxNumberLength];
+        return out.write(buffer,
+                         Literal::formatNumber(literal.numberValue, buffer));
+    }
+    if (literal.type == Literal::Type::STRING)
+        return out << literal.stringValue;
+    return out << literal.toString();
+}
@@ -0,0 +1,41 @@
+#ifndef LITERAL_HPP
+#define LITERAL_HPP
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace lox {
+    /// @brief value of a literal token or expression. Numbers are decoded
+    /// once by the scanner, so nothing downstream re-parses digits.
+    class Literal {
+      public:
+        enum class Type { NIL, BOOL, NUMBER, STRING };
+        /// @brief longest text formatNumber writes
+        static constexpr size_t maxNumberLength = 32;
+        /// @brief nil
+        Literal();
+        static Literal boolean(bool value);
+        static Literal number(double value);
+        static Literal string(std::string value);
+        /// @brief decodes the digits of a NUMBER lexeme, correctly rounded
+        static Literal parseNumber(std::string_view digits);
+        /// @brief writes the shortest digits that read back as value into
+        /// buffer (at least maxNumberLength chars), returns the length.
+        /// Fixed notation for 1e-6 <= |value| < 1e21, scientific otherwise.
+        static size_t formatNumber(double value, char* buffer);
+        /// @brief the printed form: numbers in shortest round-trip form,
+        /// strings without quotes, true, false or nil
+        std::string toString() const;
+        bool operator==(const Literal& other) const;
+        Type type;
+        bool boolValue;
+        double numberValue;
+        std::string stringValue;
+    };
+
+    /// @brief writes toString() without building a string for numbers
+    std::ostream& operator<<(std::ostream& out, const Literal& literal);
+} // namespace lox
+
+#endif // LITERAL_HPP
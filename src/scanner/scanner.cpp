@@ -1,31 +1,25 @@
 #include "scanner.hpp"
 #include "../error_handler/error_handler.hpp"
+#include "../governor/budget.hpp"
+#include "char_class.hpp"
+#include <algorithm>
+#include <utility>
 
 using namespace lox;
 
-Scanner::Scanner(const std::string& aSource, ErrorHandler& aErrorHandler)
+Scanner::Scanner(const std::string& aSource, ErrorHandler& aErrorHandler,
+                 const Budget* aBudget)
     : start(0)
     , current(0)
-    , line(1)
     , source(aSource)
-    , errorHandler(aErrorHandler) {
-    // initialize reserved keywords map
-    reservedKeywords["and"]    = TokenType::AND;
-    reservedKeywords["class"]  = TokenType::CLASS;
-    reservedKeywords["else"]   = TokenType::ELSE;
-    reservedKeywords["false"]  = TokenType::FALSE;
-    reservedKeywords["for"]    = TokenType::FOR;
-    reservedKeywords["fun"]    = TokenType::FUN;
-    reservedKeywords["if"]     = TokenType::IF;
-    reservedKeywords["nil"]    = TokenType::NIL;
-    reservedKeywords["or"]     = TokenType::OR;
-    reservedKeywords["print"]  = TokenType::PRINT;
-    reservedKeywords["return"] = TokenType::RETURN;
-    reservedKeywords["super"]  = TokenType::SUPER;
-    reservedKeywords["this"]   = TokenType::THIS;
-    reservedKeywords["true"]   = TokenType::TRUE;
-    reservedKeywords["var"]    = TokenType::VAR;
-    reservedKeywords["while"]  = TokenType::WHILE;
+    , errorHandler(aErrorHandler)
+    , budget(aBudget)
+    , lexemesUntilCheck(1)
+    , tokensBefore(0) {
+    if (source.size() > Token::maxOffset) {
+        errorHandler.add(0, "", "Source is larger than 4 GiB.");
+        current = source.size();
+    }
 }
 
 char Scanner::advanceAndGetChar() {
@@ -85,8 +79,7 @@ void Scanner::scanAndAddToken() {
         case '/':
             if (matchAndAdvance('/')) {
                 // a comment goes until the end of the line.
-                while (peek() != '\n' && !isAtEnd())
-                    (void)advanceAndGetChar();
+                (void)advanceWhile([](char c) { return c != '\n'; });
             } else {
                 addToken(TokenType::SLASH);
             }
@@ -97,10 +90,8 @@ void Scanner::scanAndAddToken() {
         case ' ':
         case '\r':
         case '\t':
-            // ignore whitespace
-            break;
         case '\n':
-            ++line;
+            // ignore whitespace
             break;
         default: {
             if (isDigit(c)) {
@@ -110,66 +101,45 @@ void Scanner::scanAndAddToken() {
             } else {
                 std::string errorMessage = "Unexpected character: ";
                 errorMessage += c;
-                errorHandler.add(line, "", errorMessage);
+                errorHandler.add(start, "", errorMessage);
                 break;
             }
         }
     }
 }
 
-bool Scanner::isAlpha(const char c) const {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
-}
-
-bool Scanner::isAlphaNumeric(const char c) const {
-    return isAlpha(c) || isDigit(c);
-}
-
 void Scanner::identifier() {
     // using "maximal munch"
     // e.g. match "orchid" not "or" keyword and "chid"
-    while (isAlphaNumeric(peek()))
-        (void)advanceAndGetChar();
+    if (!advanceWhile([](char c) { return isAlphaNumeric(c); }))
+        return;
     // see if the identifier is a reserved keyword
     const size_t identifierLength = current - start;
-    const std::string identifier  = source.substr(start, identifierLength);
-    const bool isReservedKeyword =
-        reservedKeywords.find(identifier) != reservedKeywords.end();
-    if (isReservedKeyword) {
-        addToken(reservedKeywords[identifier]);
-    } else {
-        addToken(TokenType::IDENTIFIER);
-    }
-}
-
-bool Scanner::isDigit(const char c) const {
-    return c >= '0' && c <= '9';
+    const std::string_view identifier(source.data() + start, identifierLength);
+    addToken(keywordType(identifier));
 }
 
 void Scanner::number() {
-    while (isDigit(peek()))
-        (void)advanceAndGetChar();
+    if (!advanceWhile([](char c) { return isDigit(c); }))
+        return;
     // look for fractional part
     if (peek() == '.' && isDigit(peekNext())) {
         // consume the "."
         (void)advanceAndGetChar();
-        while (isDigit(peek()))
-            (void)advanceAndGetChar();
+        if (!advanceWhile([](char c) { return isDigit(c); }))
+            return;
     }
-    const size_t numberLength       = current - start;
-    const std::string numberLiteral = source.substr(start, numberLength);
-    addToken(TokenType::NUMBER, numberLiteral);
+    const size_t numberLength = current - start;
+    const std::string_view digits(source.data() + start, numberLength);
+    addToken(TokenType::NUMBER, Literal::parseNumber(digits));
 }
 
 void Scanner::string() {
-    while (peek() != '"' && !isAtEnd()) {
-        if (peek() == '\n')
-            ++line;
-        (void)advanceAndGetChar();
-    }
+    if (!advanceWhile([](char c) { return c != '"'; }))
+        return;
     // unterminated string
     if (isAtEnd()) {
-        errorHandler.add(line, "", "Unterminated string.");
+        errorHandler.add(start, "", "Unterminated string.");
         return;
     }
     // closing "
@@ -177,17 +147,18 @@ void Scanner::string() {
     const size_t stringSize = current - start;
     // trim the surrounding quotes
     const std::string stringLiteral = source.substr(start + 1, stringSize - 2);
-    addToken(TokenType::STRING, stringLiteral);
+    addToken(TokenType::STRING, Literal::string(stringLiteral));
 }
 
-void Scanner::addToken(const TokenType aTokenType, const std::string& value) {
+void Scanner::addToken(const TokenType aTokenType, const Literal& value) {
     const size_t lexemeSize = current - start;
     const auto lexeme       = source.substr(start, lexemeSize);
-    tokens.push_back(Token(aTokenType, lexeme, value, line));
+    tokens.push_back(
+        Token(aTokenType, lexeme, value, static_cast<uint32_t>(start)));
 }
 
 void Scanner::addToken(const TokenType aTokenType) {
-    addToken(aTokenType, "");
+    addToken(aTokenType, Literal());
 }
 
 bool Scanner::isAtEnd() const {
@@ -214,12 +185,74 @@ char Scanner::peek() const {
     return source[current];
 }
 
+uint32_t Scanner::endOffset() const {
+    return static_cast<uint32_t>(std::min(source.size(), Token::maxOffset));
+}
+
+void Scanner::checkBudget() {
+    const size_t scanned = tokensBefore + tokens.size();
+    const char* reason   = budget->interrupted();
+    if (scanned > budget->maxTokens) {
+        stop("more than " + std::to_string(budget->maxTokens) + " tokens");
+    } else if (reason != nullptr) {
+        stop(reason);
+    } else {
+        // one lexeme adds at most one token, so this lands exactly on the
+        // token that goes over the limit
+        const size_t left = budget->maxTokens - scanned;
+        lexemesUntilCheck = std::min(left, Budget::checkInterval - 1) + 1;
+    }
+}
+
+template <typename Predicate>
+bool Scanner::advanceWhile(Predicate predicate) {
+    while (true) {
+        // the inner loop only compares characters, the budget is looked at
+        // between chunks
+        const size_t chunkEnd =
+            std::min(source.size(), current + Budget::checkInterval);
+        while (current < chunkEnd && predicate(source[current]))
+            ++current;
+        if (current < chunkEnd || isAtEnd())
+            return true;
+        const char* reason =
+            budget == nullptr ? nullptr : budget->interrupted();
+        if (reason != nullptr) {
+            stop(reason);
+            return false;
+        }
+    }
+}
+
+void Scanner::stop(const std::string& exceeded) {
+    errorHandler.add(start, "", "Resource limit exceeded: " + exceeded + ".");
+    current = source.size();
+}
+
 std::vector<Token> Scanner::scanAndGetTokens() {
     while (!isAtEnd()) {
         // we are at the beginning of the next lexeme
         start = current;
         scanAndAddToken();
+        if (budget != nullptr && --lexemesUntilCheck == 0)
+            checkBudget();
     }
-    tokens.push_back(Token(TokenType::END_OF_FILE, "", "", line));
+    tokens.push_back(
+        Token(TokenType::END_OF_FILE, "", Literal(), endOffset()));
     return tokens;
 }
+
+std::vector<Token> Scanner::scanBatch(const size_t maxTokens) {
+    tokens.clear();
+    while (!isAtEnd() && tokens.size() < maxTokens) {
+        start = current;
+        scanAndAddToken();
+        if (budget != nullptr && --lexemesUntilCheck == 0)
+            checkBudget();
+    }
+    if (isAtEnd())
+        tokens.push_back(
+            Token(TokenType::END_OF_FILE, "", Literal(), endOffset()));
+    tokensBefore += tokens.size();
+    return std::move(tokens);
+}
@@ -2,7 +2,6 @@
 #define SCANNER_HPP
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "token.hpp"
@@ -10,11 +9,18 @@
 namespace lox {
     // forward declarations
     class ErrorHandler;
+    struct Budget;
 
     class Scanner {
       public:
-        Scanner(const std::string& aSource, ErrorHandler& aErrorHandler);
+        /// @brief with a budget, scanning stops at the first exceeded limit,
+        /// the budget must outlive the scanner
+        Scanner(const std::string& aSource, ErrorHandler& aErrorHandler,
+                const Budget* aBudget = nullptr);
         std::vector<Token> scanAndGetTokens();
+        /// @brief scans up to maxTokens further tokens and returns them. The
+        /// batch that reaches the end of the source ends with END_OF_FILE.
+        std::vector<Token> scanBatch(size_t maxTokens);
 
       private:
         /// @brief advance and get current char
@@ -25,7 +31,7 @@ namespace lox {
         void addToken(TokenType);
         /// @brief adds token to token list with the corresponding value (used
         /// for literals mostly)
-        void addToken(TokenType, const std::string&);
+        void addToken(TokenType, const Literal&);
 
         /// @brief scans the entire source and calls processToken on each
         bool isAtEnd() const;
@@ -36,27 +42,40 @@ namespace lox {
         /// "looksahead"
         char peek() const;
         char peekNext() const;
-        bool isDigit(char) const;
-        bool isAlpha(char) const;
-        bool isAlphaNumeric(char) const;
         void string();
         void number();
         void identifier();
+        /// @brief offset of the END_OF_FILE token
+        uint32_t endOffset() const;
+        /// @brief checks the budget, called every few lexemes. Jumps to the
+        /// end of the source if a limit was exceeded.
+        void checkBudget();
+        /// @brief advances over the characters predicate holds for. Looks at
+        /// the clock and the cancel flag every Budget::checkInterval
+        /// characters, so that a single huge string or comment can't outrun
+        /// them. Returns false if that stopped scanning.
+        template <typename Predicate>
+        bool advanceWhile(Predicate predicate);
+        /// @brief reports the exceeded limit and jumps to the end of the
+        /// source
+        void stop(const std::string& exceeded);
 
         /// @brief index in source string to first character in current lexeme
         size_t start;
         /// @brief index in source string to the current lexeme
         size_t current;
-        /// @brief line number of current lexeme
-        size_t line;
         /// @brief string containing the entire lox source code
         std::string source;
         /// @brief list of all tokens
         std::vector<Token> tokens;
         /// @brief error handler for adding errors when found
         ErrorHandler& errorHandler;
-        /// @brief map of reserved keywords e.g. and, or, for, else, nil etc.
-        std::unordered_map<std::string, TokenType> reservedKeywords;
+        /// @brief limits of this job, null if unlimited
+        const Budget* budget;
+        /// @brief lexemes left to scan until checkBudget is due
+        size_t lexemesUntilCheck;
+        /// @brief tokens returned by earlier scanBatch calls
+        size_t tokensBefore;
     };
 } // namespace lox
 
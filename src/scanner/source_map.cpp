@@ -0,0 +1,75 @@
+#include "source_map.hpp"
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace lox;
+
+namespace {
+    /// @brief longest part of a source line shown in a snippet
+    const size_t maxSnippetLength = 80;
+} // namespace
+
+SourceMap::SourceMap(const std::string& aSource)
+    : source(aSource) {
+    buildNewlineIndex();
+}
+
+void SourceMap::buildNewlineIndex() {
+    const char* data  = source.data();
+    const size_t size = source.size();
+    size_t i          = 0;
+#if defined(__SSE2__)
+    // compare 16 bytes at a time and walk the set bits of the match mask
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        while (mask != 0) {
+            newlines.push_back(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (data[i] == '\n')
+            newlines.push_back(i);
+    }
+}
+
+SourceMap::Location SourceMap::locate(size_t offset) const {
+    // number of newlines before offset is the 0-based line index
+    const auto it =
+        std::lower_bound(newlines.begin(), newlines.end(), offset);
+    const size_t lineIndex = it - newlines.begin();
+    const size_t lineStart = lineIndex == 0 ? 0 : newlines[lineIndex - 1] + 1;
+    return {lineIndex + 1, offset - lineStart + 1};
+}
+
+std::string SourceMap::lineText(size_t line) const {
+    if (line == 0 || line > newlines.size() + 1)
+        return "";
+    const size_t lineStart = line == 1 ? 0 : newlines[line - 2] + 1;
+    const size_t lineEnd =
+        line <= newlines.size() ? newlines[line - 1] : source.size();
+    std::string text = source.substr(lineStart, lineEnd - lineStart);
+    // drop the '\r' of CRLF line endings
+    if (!text.empty() && text.back() == '\r')
+        text.pop_back();
+    return text;
+}
+
+std::string SourceMap::snippet(const std::string& lineText, size_t column) {
+    // show a window of the line around the column so that very long
+    // (e.g. generated) lines stay readable
+    size_t first = 0;
+    if (column > maxSnippetLength / 2)
+        first = column - 1 - maxSnippetLength / 2;
+    const size_t shownFrom = std::min(first, lineText.size());
+    return "    " + lineText.substr(shownFrom, maxSnippetLength) + "\n    " +
+           std::string(column - 1 - first, ' ') + "^\n";
+}
@@ -0,0 +1,42 @@
+#ifndef SOURCE_MAP_HPP
+#define SOURCE_MAP_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lox {
+    /// @brief resolves byte offsets in a source string to line and column
+    /// numbers. Tokens only store their offset, the newline table needed to
+    /// turn that into a line is built once (and only when a diagnostic
+    /// actually needs it).
+    class SourceMap {
+      public:
+        struct Location {
+            /// @brief 1-based line number
+            size_t line;
+            /// @brief 1-based byte column within the line
+            size_t column;
+        };
+        SourceMap(const std::string& aSource);
+        /// @brief binary searches the newline table for the given offset
+        Location locate(size_t offset) const;
+        /// @brief text of the given 1-based line without its newline
+        std::string lineText(size_t line) const;
+        /// @brief the text of a line and a caret under the given 1-based
+        /// column, both indented and newline terminated, as diagnostics show
+        /// them. Long lines are cut to a window around the column.
+        static std::string snippet(const std::string& lineText,
+                                   size_t column);
+
+      private:
+        /// @brief fills newlines with the offset of every '\n' in source
+        void buildNewlineIndex();
+        /// @brief the source the offsets refer to (not owned)
+        const std::string& source;
+        /// @brief sorted offsets of every '\n' in source
+        std::vector<size_t> newlines;
+    };
+} // namespace lox
+
+#endif // SOURCE_MAP_HPP
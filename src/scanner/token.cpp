@@ -2,17 +2,19 @@
 
 using namespace lox;
 
+constexpr size_t Token::maxOffset;
+
 Token::Token(const TokenType aType, const std::string& aLexeme,
-             const std::string& aLiteral, const int aLine)
+             const Literal& aLiteral, const uint32_t aOffset)
     : type(aType)
     , lexeme(aLexeme)
     , literal(aLiteral)
-    , line(aLine) {}
+    , offset(aOffset) {}
 
 std::string Token::toString() const {
     // for string and number literals, use actual value
     if (type == TokenType::STRING || type == TokenType::NUMBER) {
-        return literal;
+        return literal.toString();
     }
 
     return lexeme;
@@ -1,8 +1,12 @@
 #ifndef TOKEN_HPP
 #define TOKEN_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+#include "literal.hpp"
+
 namespace lox {
     enum class TokenType {
         // Single-character tokens.
@@ -58,18 +62,20 @@ namespace lox {
 
     class Token {
       public:
+        /// @brief largest source offset a token can hold, the scanner
+        /// rejects longer sources
+        static constexpr size_t maxOffset = UINT32_MAX;
         Token(TokenType aType, const std::string& aLexeme,
-              const std::string& aLiteral, int aLine);
+              const Literal& aLiteral, uint32_t aOffset);
         std::string toString() const;
         std::string lexeme;
-        // @brief literal can be of 3 types: string, number, or identifier
-        // number literals are tricky and it may seem odd that i'm storing them
-        // in a string here, but having a "polymorphic" type for literal is more
-        // work which is why i'm using a string for now and will convert to
-        // number if needed.
-        std::string literal;
+        /// @brief decoded value of STRING and NUMBER tokens, nil otherwise
+        Literal literal;
         TokenType type;
-        int line;
+        /// @brief byte offset of the lexeme in the source, line and column
+        /// are resolved from it on demand (see SourceMap). 32 bits so that it
+        /// packs with type.
+        uint32_t offset;
     };
 } // namespace lox
 
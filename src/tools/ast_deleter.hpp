@@ -0,0 +1,41 @@
+#ifndef AST_DELETER_HPP
+#define AST_DELETER_HPP
+
+#include "../Expr.hpp"
+#include <vector>
+
+namespace lox {
+    /// @brief frees an expression tree. Children are queued on a
+    /// heap-allocated stack rather than deleted recursively, so trees of any
+    /// depth can be freed.
+    class ASTDeleter : public ExprVisitor {
+      public:
+        void destroy(Expr* expr) {
+            if (expr != nullptr)
+                pending_.push_back(expr);
+            while (!pending_.empty()) {
+                Expr* next = pending_.back();
+                pending_.pop_back();
+                next->accept(this);
+                delete next;
+            }
+        }
+        void visitBinaryExpr(BinaryExpr* expr) override {
+            pending_.push_back(expr->left);
+            pending_.push_back(expr->right);
+        }
+        void visitGroupingExpr(GroupingExpr* expr) override {
+            pending_.push_back(expr->expression);
+        }
+        void visitLiteralExpr(LiteralExpr* expr) override {}
+        void visitUnaryExpr(UnaryExpr* expr) override {
+            pending_.push_back(expr->right);
+        }
+        void visitVariableExpr(VariableExpr* expr) override {}
+
+      private:
+        std::vector<Expr*> pending_;
+    };
+} // namespace lox
+
+#endif // AST_DELETER_HPP
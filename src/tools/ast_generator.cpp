@@ -27,9 +27,13 @@ namespace so_utils {
 class ASTGenerator {
   public:
     using ASTSpecification = std::pair<std::string, std::vector<std::string>>;
-    ASTGenerator(const std::string& aDir, const ASTSpecification aSpec)
+    /// @brief aInstrument makes every accept record its visit count and
+    /// cycles with the profiler (see profiler/profiler.hpp)
+    ASTGenerator(const std::string& aDir, const ASTSpecification aSpec,
+                 const bool aInstrument = false)
         : outDir(aDir)
-        , astSpec(aSpec) {}
+        , astSpec(aSpec)
+        , instrument(aInstrument) {}
     void generate() {
         std::cout << outDir << std::endl;
         defineAST();
@@ -49,6 +53,10 @@ class ASTGenerator {
 
         // Expr base abstract interface
         file << "#include \"scanner/token.hpp\"" << std::endl;
+        if (instrument) {
+            file << "#define LOX_INSTRUMENTED 1" << std::endl;
+            file << "#include \"profiler/profiler.hpp\"" << std::endl;
+        }
         file << "using namespace lox;" << std::endl;
 
         // forward declarations
@@ -66,13 +74,15 @@ class ASTGenerator {
         file << "virtual ~" << baseName << "() {}" << std::endl;
         file << "virtual void accept(" << baseName + "Visitor* visitor) = 0;"
              << std::endl;
+        defineLocate(file);
         file << "};" << std::endl;
 
         // Derived concrete classes
+        size_t kind = 0;
         for (auto type : astSpec.second) {
             auto className = type.substr(0, type.find(":"));
             auto fields    = type.substr(type.find(":") + 1, type.size());
-            defineType(file, baseName, className, fields);
+            defineType(file, baseName, className, fields, kind++);
         }
 
         /// #endif for #ifndef
@@ -81,7 +91,8 @@ class ASTGenerator {
         file.close();
     }
     void defineType(std::ofstream& file, const std::string& baseName,
-                    const std::string& className, const std::string fields) {
+                    const std::string& className, const std::string fields,
+                    const size_t kind) {
         file << "class " + className + " : public " + baseName + " { "
              << std::endl;
         file << "public: " << std::endl;
@@ -111,9 +122,14 @@ class ASTGenerator {
             auto fieldName = so_utils::split(field, " ")[1];
             file << fieldName + "(" + fieldName + ")";
         }
-        file << " {}" << std::endl;
+        file << " {";
+        if (instrument)
+            file << locateFromToken(fieldList);
+        file << "}" << std::endl;
         file << "void accept(" << baseName + "Visitor* visitor) override {"
              << std::endl;
+        if (instrument)
+            defineProfiledVisit(file, className, kind);
         file << "visitor->visit" << className << "(this);" << std::endl;
         file << "}" << std::endl;
         file << "public: " << std::endl;
@@ -128,6 +144,39 @@ class ASTGenerator {
         }
         file << "};" << std::endl;
     }
+    /// @brief emits locate(offset), which tells the profiler where in the
+    /// source a node is. It does nothing unless instrumented, where every
+    /// node also gets a profiler slot for its counters.
+    void defineLocate(std::ofstream& file) {
+        if (!instrument) {
+            file << "void locate(size_t) {}" << std::endl;
+            return;
+        }
+        file << "const size_t profileSlot = lox::profiler::newSlot();"
+             << std::endl;
+        file << "void locate(size_t offset) { "
+                "lox::profiler::locate(profileSlot, offset); }"
+             << std::endl;
+    }
+    /// @brief constructor body that locates a node at its first Token
+    /// field. Nodes without one are located by whoever builds them.
+    std::string locateFromToken(const std::vector<std::string>& fieldList) {
+        for (auto field : fieldList) {
+            auto fieldType = so_utils::split(field, " ")[0];
+            auto fieldName = so_utils::split(field, " ")[1];
+            if (!fieldType.compare("Token"))
+                return " locate(" + fieldName + ".offset); ";
+        }
+        return "";
+    }
+    /// @brief emits a ScopedVisit that times the rest of accept and records
+    /// it in the node's profiler slot
+    void defineProfiledVisit(std::ofstream& file, const std::string& className,
+                             const size_t kind) {
+        auto name = className.substr(0, className.find(" "));
+        file << "lox::profiler::ScopedVisit profiledVisit(" << kind << ", \""
+             << name << "\", profileSlot);" << std::endl;
+    }
     void defineVisitor(std::ofstream& file, const std::string& baseName) {
         auto visitorClassName = baseName + "Visitor";
         file << "class " << visitorClassName << " {" << std::endl;
@@ -145,19 +194,23 @@ class ASTGenerator {
   private:
     const std::string outDir;
     const ASTSpecification astSpec;
+    const bool instrument;
 };
 
 int main(int argc, char** argv) {
-    if (argc != 2) {
-        std::cout << "Usage: ast_generator <output directory>" << std::endl;
+    const bool instrument = argc == 3 && std::string(argv[1]) == "--instrument";
+    if (argc != 2 && !instrument) {
+        std::cout << "Usage: ast_generator [--instrument] <output directory>"
+                  << std::endl;
     } else {
-        const std::string outDir                     = argv[1];
+        const std::string outDir                     = argv[argc - 1];
         const ASTGenerator::ASTSpecification astSpec = {
             "Expr",
             {"BinaryExpr   :Expr left,Token Operator,Expr right",
-             "GroupingExpr :Expr expression", "LiteralExpr  :std::string value",
-             "UnaryExpr    :Token Operator,Expr right"}};
-        ASTGenerator astGenerator(outDir, astSpec);
+             "GroupingExpr :Expr expression", "LiteralExpr  :Literal value",
+             "UnaryExpr    :Token Operator,Expr right",
+             "VariableExpr :Token name"}};
+        ASTGenerator astGenerator(outDir, astSpec, instrument);
         astGenerator.generate();
     }
     return 0;
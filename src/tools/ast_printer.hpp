@@ -1,3 +1,6 @@
+#ifndef AST_PRINTER_HPP
+#define AST_PRINTER_HPP
+
 #include "../Expr.hpp"
 #include "../scanner/token.hpp"
 #include <iostream>
@@ -8,44 +11,91 @@
 namespace lox {
     class ASTPrinter : public ExprVisitor {
       public:
+        /// @brief RECURSIVE visits children through nested accept calls.
+        /// ITERATIVE queues them on a heap-allocated work stack instead so
+        /// that arbitrarily deep trees can be printed.
+        enum class Mode { RECURSIVE, ITERATIVE };
+        /// @brief printGroups = false prints the canonical form of the tree,
+        /// where redundant parentheses leave no trace
+        ASTPrinter(Mode mode = Mode::RECURSIVE, std::ostream& out = std::cout,
+                   bool printGroups = true)
+            : mode_(mode)
+            , out_(out)
+            , printGroups_(printGroups) {}
         void print(Expr* expr) {
-            return expr->accept(this);
+            if (mode_ == Mode::RECURSIVE)
+                return expr->accept(this);
+            pending_.push_back({expr, nullptr});
+            while (!pending_.empty()) {
+                const WorkItem item = pending_.back();
+                pending_.pop_back();
+                if (item.expr != nullptr) {
+                    item.expr->accept(this);
+                } else {
+                    out_ << item.text;
+                }
+            }
         }
         void visitBinaryExpr(BinaryExpr* expr) override {
             return parenthesize(expr->Operator.lexeme,
                                 {expr->left, expr->right});
         }
         void visitGroupingExpr(GroupingExpr* expr) override {
-            return parenthesize("group", {expr->expression});
+            if (printGroups_)
+                return parenthesize("group", {expr->expression});
+            if (mode_ == Mode::ITERATIVE)
+                return pending_.push_back({expr->expression, nullptr});
+            expr->expression->accept(this);
         }
         void visitLiteralExpr(LiteralExpr* expr) override {
-            if (expr->value.empty())
-                std::cout << "nil";
-            std::cout << " " << expr->value;
+            out_ << " " << expr->value;
         }
         void visitUnaryExpr(UnaryExpr* expr) override {
             return parenthesize(expr->Operator.lexeme, {expr->right});
         }
+        void visitVariableExpr(VariableExpr* expr) override {
+            out_ << " " << expr->name.lexeme;
+        }
         void parenthesize(std::string name, std::vector<Expr*> exprs) {
             std::string pp = "(" + name;
             // print
-            std::cout << pp;
+            out_ << pp;
+            if (mode_ == Mode::ITERATIVE) {
+                // closing paren is printed once all children are done
+                pending_.push_back({nullptr, ")"});
+                for (auto it = exprs.rbegin(); it != exprs.rend(); ++it)
+                    pending_.push_back({*it, nullptr});
+                return;
+            }
             for (auto expr : exprs) {
                 expr->accept(this);
             }
-            std::cout << ")";
+            out_ << ")";
         }
+
+      private:
+        /// @brief either an expression to visit or text to print
+        struct WorkItem {
+            Expr* expr;
+            const char* text;
+        };
+        Mode mode_;
+        std::ostream& out_;
+        bool printGroups_;
+        std::vector<WorkItem> pending_;
     };
 } // namespace lox
 
+#endif // AST_PRINTER_HPP
+
 /// EXAMPLE USE:
 // int main() {
 //     std::unique_ptr<Expr> rootExpr(
-//         new BinaryExpr(new UnaryExpr(*new Token(TokenType::MINUS, "-", "",
-//         1),
-//                                      new LiteralExpr("123")),
-//                        *new Token(TokenType::STAR, "*", "", 1),
-//                        new GroupingExpr(new LiteralExpr("45.67"))));
+//         new BinaryExpr(
+//             new UnaryExpr(Token(TokenType::MINUS, "-", Literal(), 0),
+//                           new LiteralExpr(Literal::number(123))),
+//             Token(TokenType::STAR, "*", Literal(), 4),
+//             new GroupingExpr(new LiteralExpr(Literal::number(45.67)))));
 //     ASTPrinter pp;
 //     pp.print(rootExpr.get());
 //     std::cout << std::endl;
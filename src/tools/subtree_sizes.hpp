@@ -0,0 +1,87 @@
+#ifndef SUBTREE_SIZES_HPP
+#define SUBTREE_SIZES_HPP
+
+#include "../Expr.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace lox {
+    /// @brief number of nodes under (and including) every node of a tree,
+    /// computed once after parsing. Uses a work stack, so trees of any depth
+    /// are fine.
+    ///
+    /// Nodes are addressed by their pre-order index: the root is 0, a first
+    /// child directly follows its parent and a second child follows the
+    /// subtree of the first one. Walkers can track indices that way and the
+    /// sizes are kept in a plain array.
+    class SubtreeSizes : public ExprVisitor {
+      public:
+        void compute(Expr* root) {
+            // pre-order, so every node comes before its children
+            std::vector<unsigned char> childCounts;
+            pending_.push_back(root);
+            while (!pending_.empty()) {
+                Expr* next = pending_.back();
+                pending_.pop_back();
+                const size_t pendingBefore = pending_.size();
+                next->accept(this);
+                childCounts.push_back(pending_.size() - pendingBefore);
+            }
+            // walking it backwards sees children before their parent
+            nodes_.resize(childCounts.size());
+            for (size_t index = childCounts.size(); index-- > 0;) {
+                const size_t childCount = childCounts[index];
+                Node& node              = nodes_[index];
+                node.size               = 1;
+                node.largestSplit       = 0;
+                if (childCount == 0)
+                    continue;
+                const Node& first = nodes_[index + 1];
+                node.largestSplit = first.largestSplit;
+                node.size += first.size;
+                if (childCount == 1)
+                    continue;
+                const Node& second = nodes_[index + 1 + first.size];
+                const size_t split = std::min(first.size, second.size);
+                node.size += second.size;
+                node.largestSplit =
+                    std::max({node.largestSplit, second.largestSplit, split});
+            }
+        }
+        /// @brief size of the subtree at pre-order index
+        size_t of(size_t index) const {
+            return nodes_[index].size;
+        }
+        /// @brief size of the smaller child of the most evenly split node
+        /// in the subtree at pre-order index, 0 if it has no binary nodes.
+        /// Below that size a subtree can't be split into two large parts.
+        size_t largestSplit(size_t index) const {
+            return nodes_[index].largestSplit;
+        }
+        void visitBinaryExpr(BinaryExpr* expr) override {
+            pending_.push_back(expr->right);
+            pending_.push_back(expr->left);
+        }
+        void visitGroupingExpr(GroupingExpr* expr) override {
+            pending_.push_back(expr->expression);
+        }
+        void visitLiteralExpr(LiteralExpr* expr) override {}
+        void visitUnaryExpr(UnaryExpr* expr) override {
+            pending_.push_back(expr->right);
+        }
+        void visitVariableExpr(VariableExpr* expr) override {}
+
+      private:
+        struct Node {
+            size_t size;
+            size_t largestSplit;
+        };
+        /// @brief children of the visited nodes
+        std::vector<Expr*> pending_;
+        /// @brief indexed by pre-order index
+        std::vector<Node> nodes_;
+    };
+} // namespace lox
+
+#endif // SUBTREE_SIZES_HPP